@@ -0,0 +1,31 @@
+#pragma once
+#include <cstdint>
+#include <chrono>
+
+#if defined(__x86_64__) || defined(__i386__)
+#include <x86intrin.h>
+#endif
+
+namespace bench {
+
+    /// @brief Cycle counter, falls back to nanoseconds where no timestamp counter is available
+    inline uint64_t Cycles() {
+    #if defined(__x86_64__) || defined(__i386__)
+        return __rdtsc();
+    #else
+        return std::chrono::duration_cast<std::chrono::nanoseconds>(std::chrono::steady_clock::now().time_since_epoch()).count();
+    #endif
+    }
+
+    /// @brief Keeps the compiler from optimizing away a result
+    template <typename T> inline void DoNotOptimize(const T& value) {
+        asm volatile("" : : "r,m"(value) : "memory");
+    }
+
+    /// @brief Hides where a pointer came from, so calls through it can't be devirtualized from the allocation site
+    template <typename T> inline T* Opaque(T* p) {
+        asm volatile("" : "+r"(p));
+        return p;
+    }
+
+} // namespace bench
@@ -0,0 +1,84 @@
+#include "Bench.hpp"
+#include "../src/Checksum.hpp"
+#include <iostream>
+#include <iomanip>
+#include <random>
+#include <vector>
+
+// build: g++ -std=c++11 -O2 bench/ChecksumBench.cpp -o checksum_bench
+
+/// @brief The original per-byte modulo fletcher16, kept as the baseline
+struct ModuloFletcher16 {
+    static inline uint16_t Compute(const uint8_t* data, size_t len) {
+        uint16_t sum1 = 0;
+        uint16_t sum2 = 0;
+
+        for (size_t i = 0; i < len; i++) {
+            sum1 = (sum1 + data[i]) % 255;
+            sum2 = (sum2 + sum1) % 255;
+        }
+
+        return (sum2 << 8) | sum1;
+    }
+};
+
+/// @brief Byte at a time through the running State, the path taken while a frame is being received
+template <typename Policy> struct Incremental {
+    static inline typename Policy::Type Compute(const uint8_t* data, size_t len) {
+        typename Policy::State s;
+        Policy::Reset(s);
+        for (size_t i = 0; i < len; i++) Policy::Update(s, data[i]);
+        return Policy::Final(s);
+    }
+};
+
+template <typename Policy> double CyclesPerByte(const std::vector<uint8_t>& buffer, size_t len) {
+    const size_t bytesTotal = 64 * 1024 * 1024;
+    const size_t iterations = bytesTotal / len;
+
+    // warm up caches and lazily built tables
+    for (size_t i = 0; i < 1024; i++) bench::DoNotOptimize(Policy::Compute(buffer.data(), len));
+
+    uint64_t best = ~0ull;
+    for (int run = 0; run < 5; run++) {
+        const uint64_t start = bench::Cycles();
+        for (size_t i = 0; i < iterations; i++) {
+            bench::DoNotOptimize(Policy::Compute(buffer.data() + (i & 63), len));
+        }
+        const uint64_t elapsed = bench::Cycles() - start;
+        if (elapsed < best) best = elapsed;
+    }
+
+    return (double)best / (double)(iterations * len);
+}
+
+template <typename Policy> void Report(const char* name, const std::vector<uint8_t>& buffer, const size_t* sizes, size_t count) {
+    std::cout << std::left << std::setw(24) << name << std::right;
+    for (size_t i = 0; i < count; i++) {
+        std::cout << std::setw(10) << std::fixed << std::setprecision(2) << CyclesPerByte<Policy>(buffer, sizes[i]);
+    }
+    std::cout << "\n";
+}
+
+int main() {
+    // 11 is the checksummed span of a default frame
+    const size_t sizes[] = { 11, 64, 256, 1024, 4096 };
+    const size_t count = sizeof(sizes) / sizeof(sizes[0]);
+
+    std::mt19937 gen(1);
+    std::vector<uint8_t> buffer(4096 + 64);
+    for (uint8_t& b : buffer) b = (uint8_t)gen();
+
+    std::cout << "cycles / byte\n" << std::left << std::setw(24) << "policy" << std::right;
+    for (size_t i = 0; i < count; i++) std::cout << std::setw(9) << sizes[i] << "B";
+    std::cout << "\n";
+
+    Report<ModuloFletcher16>("Fletcher16 (modulo)", buffer, sizes, count);
+    Report<pckt::chk::Fletcher16>("Fletcher16", buffer, sizes, count);
+    Report<Incremental<pckt::chk::Fletcher16>>("Fletcher16 (per byte)", buffer, sizes, count);
+    Report<pckt::chk::Crc16Ccitt>("Crc16Ccitt", buffer, sizes, count);
+    Report<pckt::chk::Crc32<1>>("Crc32<1>", buffer, sizes, count);
+    Report<pckt::chk::Crc32<4>>("Crc32<4>", buffer, sizes, count);
+    Report<pckt::chk::Crc32<8>>("Crc32<8>", buffer, sizes, count);
+    Report<Incremental<pckt::chk::Crc32<1>>>("Crc32 (per byte)", buffer, sizes, count);
+}
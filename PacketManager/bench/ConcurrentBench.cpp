@@ -0,0 +1,125 @@
+#include "Bench.hpp"
+#include "../src/Concurrent.hpp"
+#include <atomic>
+#include <cstdlib>
+#include <cstring>
+#include <iostream>
+#include <iomanip>
+#include <mutex>
+#include <thread>
+#include <vector>
+
+// build: g++ -std=c++11 -O2 -pthread bench/ConcurrentBench.cpp -o concurrent_bench
+//
+// concurrent_bench [--frames 4000000] [--threads 32]
+//   1 to threads producers send frames as fast as they are taken into one link that discards them, through a
+//   ConcurrentManager and through a manager behind a global mutex, each send flushed as it would be on a live link.
+//   Reports aggregate million frames / s of both and the speedup of the ConcurrentManager, best of 3 runs. Past
+//   the cores there are, producers only add contention
+struct TxConfig : public pckt::DefaultConfig {
+    static constexpr size_t TX_QUEUE_SIZE = 1024;
+};
+
+/// @brief Counts the frames written and drops them
+struct SinkTransport final : public pckt::StaticTransport {
+    public:
+    inline int read(uint8_t* data, size_t len) { (void)data; (void)len; return 0; }
+
+    inline size_t write(const uint8_t* data, size_t len) {
+        bench::DoNotOptimize(data);
+        written.fetch_add(len / sizeof(pckt::Packet<TxConfig>), std::memory_order_relaxed);
+        return len;
+    }
+
+    inline bool available() { return false; }
+
+    std::atomic<size_t> written{0};
+};
+
+/// @brief Runs producers sending perProducer frames each through send, seconds until sink has written them all
+template <typename F> static double Run(SinkTransport& sink, size_t producers, size_t perProducer, F send) {
+    const size_t total = producers * perProducer;
+    std::atomic<bool> go(false);
+
+    std::vector<std::thread> threads;
+    for (size_t p = 0; p < producers; p++) {
+        threads.emplace_back([&, p] {
+            uint8_t payload[TxConfig::MAX_PAYLOAD_SIZE] = {};
+            payload[0] = (uint8_t)p;
+            while (!go.load(std::memory_order_acquire)) std::this_thread::yield();
+
+            for (size_t i = 0; i < perProducer; i++) {
+                payload[1] = (uint8_t)i;
+                while (send(payload) == pckt::SendStatus::WouldBlock) std::this_thread::yield();
+            }
+        });
+    }
+
+    const auto start = std::chrono::steady_clock::now();
+    go.store(true, std::memory_order_release);
+    for (auto& t : threads) t.join();
+    while (sink.written.load(std::memory_order_relaxed) < total) std::this_thread::yield();
+
+    return std::chrono::duration<double>(std::chrono::steady_clock::now() - start).count();
+}
+
+/// @brief Million frames / s of producers sending through one ConcurrentManager
+static double Concurrent(size_t producers, size_t frames) {
+    double best = 1e30;
+    for (int run = 0; run < 3; run++) {
+        SinkTransport sink;
+        trns::ConcurrentManager<TxConfig, SinkTransport> link(sink, -1, 0);
+        link.Start();
+
+        const double elapsed = Run(sink, producers, frames / producers, [&](const uint8_t* payload) {
+            return link.Send(pckt::Type::DataPacket, payload, TxConfig::MAX_PAYLOAD_SIZE);
+        });
+
+        link.Stop();
+        if (elapsed < best) best = elapsed;
+    }
+
+    return (double)(frames / producers * producers) / best / 1e6;
+}
+
+/// @brief Million frames / s of producers sending through one manager, each send and flush under a global mutex
+static double Locked(size_t producers, size_t frames) {
+    double best = 1e30;
+    for (int run = 0; run < 3; run++) {
+        SinkTransport sink;
+        pckt::PacketManager<TxConfig, SinkTransport> manager(sink);
+        std::mutex lock;
+
+        const double elapsed = Run(sink, producers, frames / producers, [&](const uint8_t* payload) {
+            std::lock_guard<std::mutex> guard(lock);
+            const pckt::SendStatus status = manager.Send(pckt::Type::DataPacket, payload, TxConfig::MAX_PAYLOAD_SIZE);
+            manager.Flush();
+            return status;
+        });
+
+        if (elapsed < best) best = elapsed;
+    }
+
+    return (double)(frames / producers * producers) / best / 1e6;
+}
+
+int main(int argc, char** argv) {
+    size_t frames = 4000000;
+    size_t maxThreads = 32;
+    for (int i = 1; i + 1 < argc; i += 2) {
+        if (!strcmp(argv[i], "--frames")) frames = strtoul(argv[i+1], nullptr, 10);
+        else if (!strcmp(argv[i], "--threads")) maxThreads = strtoul(argv[i+1], nullptr, 10);
+    }
+
+    std::cout << std::thread::hardware_concurrency() << " cores, " << frames << " frames per run, million frames / s\n";
+    std::cout << std::left << std::setw(10) << "threads" << std::right << std::setw(12) << "concurrent"
+              << std::setw(12) << "mutex" << std::setw(10) << "speedup" << "\n";
+
+    for (size_t producers = 1; producers <= maxThreads; producers *= 2) {
+        const double concurrent = Concurrent(producers, frames);
+        const double locked = Locked(producers, frames);
+
+        std::cout << std::left << std::setw(10) << producers << std::right << std::fixed << std::setprecision(2)
+                  << std::setw(12) << concurrent << std::setw(12) << locked << std::setw(9) << concurrent / locked << "x\n";
+    }
+}
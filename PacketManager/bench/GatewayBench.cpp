@@ -0,0 +1,124 @@
+#include "Bench.hpp"
+#include "../src/Gateway.hpp"
+#include <atomic>
+#include <cstdlib>
+#include <cstring>
+#include <iostream>
+#include <iomanip>
+#include <thread>
+#include <vector>
+
+// build: g++ -std=c++11 -O2 -pthread bench/GatewayBench.cpp -o gateway_bench
+//
+// gateway_bench [--frames 4000000] [--threads 8]
+//   every link replays its own copy of a stream of frames from memory, so only decoding and the hand off to
+//   consumers are measured. Reports aggregate million frames / s for 64 to 4096 links on 1 to threads workers,
+//   with a consumer per two workers, and the speedup over a single worker. Workers are pinned to cores, the
+//   speedup can only follow the worker count up to the cores there are
+
+/// @brief Replays a shared stream from memory, a span at a time
+struct ReplayTransport final : public pckt::StaticTransport {
+    public:
+    ReplayTransport(const std::vector<uint8_t>& stream) : stream(stream) {}
+
+    inline int read(uint8_t* data, size_t len) {
+        const size_t left = stream.size() - head;
+        if (len > left) len = left;
+        memcpy(data, stream.data() + head, len);
+        head += len;
+        return (int)len;
+    }
+
+    inline size_t write(const uint8_t* data, size_t len) { (void)data; return len; }
+
+    inline bool available() { return head < stream.size(); }
+
+    inline size_t peek(const uint8_t*& data) {
+        const size_t left = stream.size() - head;
+        data = stream.data() + head;
+        return left < 4096 ? left : 4096;
+    }
+
+    inline void consume(size_t len) { head += len; }
+
+    const std::vector<uint8_t>& stream;
+    size_t head = 0;
+};
+
+using Gateway = trns::Gateway<pckt::DefaultConfig, ReplayTransport>;
+
+/// @brief Million frames / s for links each replaying stream on workers
+static double Run(const std::vector<uint8_t>& stream, size_t framesPerLink, size_t links, size_t workers) {
+    std::vector<std::unique_ptr<ReplayTransport>> transports;
+    Gateway gateway(workers);
+    for (size_t l = 0; l < links; l++) {
+        transports.emplace_back(new ReplayTransport(stream));
+        gateway.Add(*transports.back());
+    }
+
+    const size_t consumers = (workers + 1) / 2;
+    const size_t total = framesPerLink * links;
+    std::atomic<size_t> delivered(0);
+
+    const auto start = std::chrono::steady_clock::now();
+    gateway.Start();
+
+    std::vector<std::thread> threads;
+    for (size_t c = 0; c < consumers; c++) {
+        threads.emplace_back([&, c] {
+            size_t sum = 0;
+            while (delivered.load(std::memory_order_relaxed) < total) {
+                const size_t drained = gateway.Drain(c, consumers, [&](const Gateway::Frame& frame) { sum += frame.packet.payload[0]; });
+                if (drained) delivered += drained;
+                else std::this_thread::yield();
+            }
+            bench::DoNotOptimize(sum);
+        });
+    }
+
+    for (auto& t : threads) t.join();
+    const auto elapsed = std::chrono::steady_clock::now() - start;
+    gateway.Stop();
+
+    return (double)total / std::chrono::duration<double, std::micro>(elapsed).count();
+}
+
+int main(int argc, char** argv) {
+    size_t frames = 4000000;
+    size_t maxThreads = 8;
+    for (int i = 1; i + 1 < argc; i += 2) {
+        if (!strcmp(argv[i], "--frames")) frames = strtoul(argv[i+1], nullptr, 10);
+        else if (!strcmp(argv[i], "--threads")) maxThreads = strtoul(argv[i+1], nullptr, 10);
+    }
+
+    std::cout << std::thread::hardware_concurrency() << " cores, " << frames << " frames per run, million frames / s (speedup over 1 worker)\n";
+    std::cout << std::left << std::setw(8) << "links";
+    for (size_t w = 1; w <= maxThreads; w *= 2) std::cout << std::right << std::setw(10) << w << std::setw(7) << "";
+    std::cout << "\n";
+
+    const size_t linkCounts[] = { 64, 1024, 4096 };
+    for (size_t links : linkCounts) {
+        const size_t framesPerLink = frames / links;
+
+        pckt::Packet<> frame;
+        std::vector<uint8_t> stream;
+        for (size_t i = 0; i < framesPerLink; i++) {
+            frame.type = (uint8_t)pckt::Type::DataPacket;
+            frame.flags = 0;
+            for (size_t b = 0; b < sizeof(frame.payload); b++) frame.payload[b] = (uint8_t)(i + b) & 0x7F;
+            frame.checksum = pckt::DefaultConfig::Checksum::Compute(frame.self(), sizeof(frame) - sizeof(frame.checksum));
+            stream.insert(stream.end(), frame.self(), frame.self() + sizeof(frame));
+        }
+
+        std::cout << std::left << std::setw(8) << links << std::right << std::fixed << std::setprecision(2);
+
+        double single = 0;
+        for (size_t w = 1; w <= maxThreads; w *= 2) {
+            const double rate = Run(stream, framesPerLink, links, w);
+            if (w == 1) single = rate;
+            std::cout << std::setw(10) << rate << " (" << std::setprecision(1) << rate / single << "x)" << std::setprecision(2);
+        }
+
+        std::cout << "\n";
+    }
+}
@@ -0,0 +1,183 @@
+#include "../src/PacketManager.hpp"
+#include <algorithm>
+#include <cstdlib>
+#include <cstring>
+#include <iostream>
+#include <iomanip>
+#include <vector>
+
+// build: g++ -std=c++11 -O2 bench/LatencyBench.cpp -o latency_bench
+//
+// latency_bench [--bound 4]
+//   a link that carries LINK_RATE bytes per tick is kept saturated with telemetry on channels 1 and 2 while
+//   a critical command is sent every CONTROL_PERIOD ticks. Reports how many ticks every frame took from
+//   Send to its handler, for one FIFO queue, strict priority and weighted channels, exits 1 if a command
+//   took more than bound ticks on a scheduled config
+
+static constexpr size_t LINK_RATE = 11;
+static constexpr uint32_t CONTROL_PERIOD = 50;
+static constexpr uint32_t TICKS = 200000;
+
+/// @brief Both ends of a throttled link, write takes at most budget bytes per tick and read hands them to the receiver
+struct LinkTransport : public pckt::StaticTransport {
+    public:
+    inline int read(uint8_t* data, size_t len) {
+        const size_t left = wire.size() - head;
+        if (len > left) len = left;
+        memcpy(data, wire.data() + head, len);
+        head += len;
+        return (int)len;
+    }
+
+    inline size_t write(const uint8_t* data, size_t len) {
+        if (len > budget) len = budget;
+        wire.insert(wire.end(), data, data + len);
+        budget -= len;
+        return len;
+    }
+
+    inline bool available() { return head < wire.size(); }
+
+    /// @brief Next tick, drops what was read and refills the budget
+    inline void Tick() {
+        wire.erase(wire.begin(), wire.begin() + head);
+        head = 0;
+        budget = LINK_RATE;
+    }
+
+    std::vector<uint8_t> wire;
+    size_t head = 0;
+    size_t budget = 0;
+};
+
+struct FifoConfig : public pckt::DefaultConfig {
+    static constexpr size_t TX_QUEUE_SIZE = 256;
+    static constexpr unsigned long TX_FLUSH_TIMEOUT = 0;
+};
+
+struct StrictConfig : public FifoConfig {
+    static constexpr uint8_t TX_CHANNELS = 3;
+};
+
+struct WeightedConfig : public StrictConfig {
+    static constexpr pckt::Schedule TX_SCHEDULE = pckt::Schedule::Weighted;
+    static constexpr uint8_t TxWeight(uint8_t channel) { return channel == 1 ? 3 : 1; }
+};
+
+
+// payload is the channel followed by the tick the frame was sent on
+static uint32_t now = 0;
+static std::vector<uint32_t> latencies[3];
+template <typename P> static void Handler(const P& packet) {
+    uint32_t sentAt;
+    memcpy(&sentAt, packet.payload + 1, sizeof(sentAt));
+    latencies[packet.payload[0]].push_back(now - sentAt);
+}
+
+
+struct Summary {
+    double mean;
+    uint32_t p99;
+    uint32_t max;
+    size_t frames;
+};
+
+static Summary Summarize(std::vector<uint32_t>& ticks) {
+    Summary s = { 0, 0, 0, ticks.size() };
+    if (ticks.empty()) return s;
+
+    std::sort(ticks.begin(), ticks.end());
+    double sum = 0;
+    for (uint32_t t : ticks) sum += t;
+
+    s.mean = sum / ticks.size();
+    s.p99 = ticks[(ticks.size() - 1) * 99 / 100];
+    s.max = ticks.back();
+    return s;
+}
+
+template <typename Config> void Run(const char* name, bool scheduled, uint32_t bound, bool& overBound) {
+    LinkTransport link;
+    pckt::PacketManager<Config, LinkTransport> tx(link);
+    pckt::PacketManager<Config, LinkTransport> rx(link);
+    rx.Callback(pckt::Type::DataPacket, Handler);
+
+    for (auto& l : latencies) l.clear();
+
+    uint8_t payload[Config::MAX_PAYLOAD_SIZE] = {};
+    bool commandDue = false;
+    uint32_t commandAt = 0;
+
+    for (now = 0; now < TICKS; now++) {
+        link.Tick();
+
+        // a command that didn't fit keeps the tick it was due on and is retried first
+        if (now % CONTROL_PERIOD == 0 && !commandDue) {
+            commandDue = true;
+            commandAt = now;
+        }
+
+        if (commandDue) {
+            payload[0] = 0;
+            memcpy(payload + 1, &commandAt, sizeof(commandAt));
+
+            tx.SetCritical(true);
+            commandDue = tx.Send(pckt::Type::DataPacket, payload, sizeof(payload)) == pckt::SendStatus::WouldBlock;
+            tx.SetCritical(false);
+        }
+
+        // telemetry offers more than the link carries, the channels take turns at whatever room the queue has
+        for (int i = 0; i < 4; i++) {
+            const uint8_t channel = 1 + (now + i) % 2;
+            payload[0] = channel;
+            memcpy(payload + 1, &now, sizeof(now));
+
+            tx.SetChannel(channel);
+            tx.Send(pckt::Type::DataPacket, payload, sizeof(payload));
+        }
+
+        tx.Flush();
+        while (link.available()) rx.Update();
+    }
+
+    const Summary control = Summarize(latencies[0]);
+    const Summary first = Summarize(latencies[1]);
+    const Summary second = Summarize(latencies[2]);
+
+    std::cout << std::left << std::setw(10) << name << std::right << std::fixed << std::setprecision(1);
+    for (const Summary* s : { &control, &first, &second }) {
+        std::cout << std::setw(8) << s->mean << std::setw(6) << s->p99 << std::setw(6) << s->max << std::setw(8) << s->frames;
+    }
+
+    if (scheduled && control.max > bound) {
+        std::cout << "  over bound";
+        overBound = true;
+    }
+    std::cout << "\n";
+}
+
+
+int main(int argc, char** argv) {
+    uint32_t bound = 4;
+    for (int i = 1; i + 1 < argc; i += 2) {
+        if (!strcmp(argv[i], "--bound")) bound = (uint32_t)strtoul(argv[i+1], nullptr, 10);
+    }
+
+    std::cout << "ticks from Send to handler, " << LINK_RATE << " bytes per tick, a command every " << CONTROL_PERIOD << " ticks\n";
+    std::cout << std::left << std::setw(10) << "" << std::right;
+    for (const char* channel : { "command", "channel 1", "channel 2" }) {
+        std::cout << std::setw(28) << channel;
+    }
+    std::cout << "\n" << std::left << std::setw(10) << "queue" << std::right;
+    for (int i = 0; i < 3; i++) {
+        std::cout << std::setw(8) << "mean" << std::setw(6) << "p99" << std::setw(6) << "max" << std::setw(8) << "frames";
+    }
+    std::cout << "\n";
+
+    bool overBound = false;
+    Run<FifoConfig>("fifo", false, bound, overBound);
+    Run<StrictConfig>("strict", true, bound, overBound);
+    Run<WeightedConfig>("weighted", true, bound, overBound);
+
+    return overBound ? 1 : 0;
+}
@@ -0,0 +1,134 @@
+#include "../src/PacketManager.hpp"
+#include "../src/Emulator.hpp"
+#include "../src/RingBufferTransport.hpp"
+#include <algorithm>
+#include <cstdlib>
+#include <cstring>
+#include <iostream>
+#include <iomanip>
+#include <vector>
+
+// build: g++ -std=c++11 -O2 bench/LinkBench.cpp -o link_bench
+//
+// link_bench [--seconds 2] [--load 0.8] [--seed 1]
+//   a sender offers frames at load times the link's rate through a LinkEmulator, the receiver decodes them in the
+//   same process. Reports goodput in payload kB/s and as a share of the link rate, the frames delivered, and send
+//   to handler latency percentiles in ms for a clean and a noisy 115200 baud serial port, errors in bursts at the
+//   same mean rate, and a Bluetooth serial profile like link with long, jittery latency. The models are examples,
+//   measure the real link and set them to match
+struct LinkConfig : public pckt::DefaultConfig {
+    static constexpr size_t MAX_PAYLOAD_SIZE = 32;
+    static constexpr bool VARIABLE_LENGTH = true;
+    static constexpr size_t TX_QUEUE_SIZE = 256;
+    using Checksum = pckt::chk::Crc16Ccitt;
+};
+
+using Packet = pckt::Packet<LinkConfig>;
+using Loopback = trns::RingBufferTransport<1 << 16>;
+
+static std::vector<unsigned long> sentAt;
+static std::vector<unsigned long> latencies;
+static size_t payloadBytes = 0;
+
+static void Handler(const Packet& packet) {
+    uint32_t i;
+    if (packet.len < sizeof(i)) return;
+
+    memcpy(&i, packet.payload, sizeof(i));
+    if (i >= sentAt.size()) return;
+
+    latencies.push_back(pckt::Micros() - sentAt[i]);
+    payloadBytes += packet.len;
+}
+
+static void Report(const char* name, const trns::LinkModel& model, double seconds, double load) {
+    Loopback loopback;
+    trns::LinkEmulator<Loopback, 1 << 14> link(loopback, model);
+    pckt::PacketManager<LinkConfig, trns::LinkEmulator<Loopback, 1 << 14>> tx(link);
+    pckt::PacketManager<LinkConfig, trns::LinkEmulator<Loopback, 1 << 14>> rx(link);
+    rx.Callback(pckt::Type::DataPacket, Handler);
+
+    sentAt.clear();
+    latencies.clear();
+    payloadBytes = 0;
+
+    // full frames offered evenly at load times the rate
+    const unsigned long interval = (unsigned long)(sizeof(Packet) * 1e6 / (model.bytesPerSecond * load));
+    uint8_t payload[LinkConfig::MAX_PAYLOAD_SIZE];
+    for (size_t b = 0; b < sizeof(payload); b++) payload[b] = (uint8_t)(b * 7);
+
+    const unsigned long start = pckt::Micros();
+    const unsigned long end = start + (unsigned long)(seconds * 1e6);
+    unsigned long next = start;
+
+    while ((long)(pckt::Micros() - end) < 0) {
+        if ((long)(pckt::Micros() - next) >= 0) {
+            const uint32_t i = (uint32_t)sentAt.size();
+            memcpy(payload, &i, sizeof(i));
+            if (tx.Send(pckt::Type::DataPacket, payload, sizeof(payload)) != pckt::SendStatus::WouldBlock) sentAt.push_back(pckt::Micros());
+            next += interval;
+        }
+
+        tx.Flush();
+        rx.Update();
+    }
+
+    // what is still in flight gets a second to arrive
+    const unsigned long drain = pckt::Micros();
+    while (pckt::Micros() - drain < 1000000 && (tx.Pending() || link.Queued() || loopback.Size())) {
+        tx.Flush();
+        rx.Update();
+    }
+
+    const double elapsed = (pckt::Micros() - start) / 1e6;
+    std::sort(latencies.begin(), latencies.end());
+    const auto percentile = [](double p) { return latencies.empty() ? 0.0 : latencies[(size_t)(p * (latencies.size() - 1))] / 1000.0; };
+
+    const double goodput = payloadBytes / elapsed;
+    std::cout << std::left << std::setw(28) << name << std::right << std::fixed << std::setprecision(2)
+              << std::setw(10) << goodput / 1000 << std::setw(8) << std::setprecision(0) << 100 * goodput / model.bytesPerSecond << "%"
+              << std::setw(9) << std::setprecision(1) << 100.0 * latencies.size() / (sentAt.empty() ? 1 : sentAt.size()) << "%"
+              << std::setprecision(2) << std::setw(9) << percentile(0.5) << std::setw(9) << percentile(0.99) << std::setw(9) << percentile(1.0) << "\n";
+}
+
+int main(int argc, char** argv) {
+    double seconds = 2;
+    double load = 0.8;
+    uint32_t seed = 1;
+    for (int i = 1; i + 1 < argc; i += 2) {
+        if (!strcmp(argv[i], "--seconds")) seconds = strtod(argv[i+1], nullptr);
+        else if (!strcmp(argv[i], "--load")) load = strtod(argv[i+1], nullptr);
+        else if (!strcmp(argv[i], "--seed")) seed = (uint32_t)strtoul(argv[i+1], nullptr, 10);
+    }
+
+    std::cout << sizeof(Packet) << " byte frames offered at " << load * 100 << "% of the link rate for " << seconds << " s\n"
+              << std::left << std::setw(28) << "link" << std::right << std::setw(10) << "kB/s" << std::setw(9) << "of rate"
+              << std::setw(10) << "arrived" << std::setw(9) << "p50 ms" << std::setw(9) << "p99 ms" << std::setw(9) << "max ms" << "\n";
+
+    trns::LinkModel uart = trns::LinkModel::Uart(115200);
+    uart.seed = seed;
+    Report("uart 115200", uart, seconds, load);
+
+    trns::LinkModel noisy = uart;
+    noisy.bitErrorRate = 1e-5;
+    noisy.dropRate = 1e-6;
+    Report("uart 115200, ber 1e-5", noisy, seconds, load);
+
+    // the same mean bit error rate, in bursts of 20 bytes on average
+    trns::LinkModel bursty = uart;
+    bursty.enterBurst = 0.0005;
+    bursty.leaveBurst = 0.05;
+    bursty.burstErrorRate = 1e-5 * (bursty.enterBurst + bursty.leaveBurst) / bursty.enterBurst;
+    Report("uart 115200, bursts 1e-5", bursty, seconds, load);
+
+    // bytes arrive in radio packets with 10 to 40 ms of latency, the radio retransmits so nothing is corrupted
+    trns::LinkModel bluetooth;
+    bluetooth.seed = seed;
+    bluetooth.bytesPerSecond = 20000;
+    bluetooth.fifo = 512;
+    bluetooth.latency = 10000;
+    bluetooth.jitter = 30000;
+    bluetooth.shortReadRate = 0.5;
+    bluetooth.shortWriteRate = 0.2;
+    Report("bluetooth spp", bluetooth, seconds, load);
+}
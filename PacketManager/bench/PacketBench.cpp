@@ -0,0 +1,289 @@
+#include "Bench.hpp"
+#include "../src/PacketManager.hpp"
+#include <cstdio>
+#include <cstdlib>
+#include <cstring>
+#include <fstream>
+#include <iostream>
+#include <iomanip>
+#include <new>
+#include <random>
+#include <sstream>
+#include <string>
+#include <vector>
+
+// build: g++ -std=c++11 -O2 bench/PacketBench.cpp -o packet_bench
+//
+// packet_bench [--out results.csv] [--baseline baseline.csv] [--tolerance 10]
+//   --out       writes one csv row per scenario and decode path
+//   --baseline  compares against a csv from an earlier --out, exits 1 if any ns / frame regressed past tolerance %
+
+static size_t allocations = 0;
+
+void* operator new(size_t size) {
+    allocations++;
+    void* p = malloc(size ? size : 1);
+    if (!p) throw std::bad_alloc();
+    return p;
+}
+
+void operator delete(void* p) noexcept { free(p); }
+
+
+/// @brief Replays a stream from memory, split into chunks that a read or span never crosses
+struct MemoryTransport : public pckt::StaticTransport {
+    public:
+    MemoryTransport(const std::vector<uint8_t>& stream, const std::vector<size_t>& chunks) : stream(stream), chunks(chunks) {}
+
+    inline int read(uint8_t* data, size_t len) {
+        if (len > left) len = left;
+        memcpy(data, stream.data() + head, len);
+        Advance(len);
+        return (int)len;
+    }
+
+    inline size_t write(const uint8_t* data, size_t len) { (void)data; return len; }
+
+    inline bool available() { return head < stream.size(); }
+
+    inline size_t peek(const uint8_t*& data) {
+        data = stream.data() + head;
+        return spans ? left : 0;
+    }
+
+    inline void consume(size_t len) { Advance(len); }
+
+    inline void Rewind() {
+        head = 0;
+        chunk = 0;
+        left = chunks[0];
+    }
+
+    const std::vector<uint8_t>& stream;
+    const std::vector<size_t>& chunks;
+    bool spans = false;
+
+    private:
+    size_t head = 0;
+    size_t chunk = 0;
+    size_t left = 0;
+
+    inline void Advance(size_t len) {
+        head += len;
+        left -= len;
+        if (!left && ++chunk < chunks.size()) left = chunks[chunk];
+    }
+};
+
+
+struct BatchConfig : public pckt::DefaultConfig {
+    static constexpr size_t RX_BATCH_SIZE = 64;
+};
+
+static size_t delivered = 0;
+template <typename P> static void Handler(const P& packet) { delivered += packet.payload[0] != 0xFF; }
+
+
+/// @brief A fixed stream and how it is chunked, built once from a fixed seed
+struct Scenario {
+    const char* name;
+    std::vector<uint8_t> stream;
+    std::vector<size_t> chunks;
+    size_t frames;
+};
+
+enum class Damage { None, Noise, Checksum, Split, Payload };
+
+Scenario Build(const char* name, Damage damage, size_t frames, uint32_t seed) {
+    Scenario s;
+    s.name = name;
+    s.frames = frames;
+
+    std::mt19937 gen(seed);
+    pckt::Packet<> frame;
+    for (size_t i = 0; i < frames; i++) {
+        frame.type = (uint8_t)pckt::Type::DataPacket;
+        frame.flags = 0;
+        for (size_t b = 0; b < sizeof(frame.payload); b++) frame.payload[b] = (uint8_t)gen() & 0x7F;
+        frame.checksum = pckt::DefaultConfig::Checksum::Compute(frame.self(), sizeof(frame) - sizeof(frame.checksum));
+
+        // 16 bytes of noise before every frame
+        if (damage == Damage::Noise) {
+            for (int n = 0; n < 16; n++) s.stream.push_back((uint8_t)gen());
+        }
+
+        const size_t at = s.stream.size();
+        s.stream.insert(s.stream.end(), frame.self(), frame.self() + sizeof(frame));
+
+        // every other frame damaged
+        if (i%2 == 0 && damage == Damage::Checksum) s.stream[at + sizeof(frame) - 1] ^= 0x5A;
+        if (i%2 == 0 && damage == Damage::Payload) s.stream[at + pckt::Packet<>::HEADER_SIZE + gen() % sizeof(frame.payload)] ^= 0x80;
+    }
+
+    // split frames arrive in 1 to 2 frame sized chunks, everything else all at once
+    if (damage == Damage::Split) {
+        for (size_t left = s.stream.size(); left;) {
+            size_t n = 1 + gen() % (2*sizeof(frame));
+            if (n > left) n = left;
+            s.chunks.push_back(n);
+            left -= n;
+        }
+    } else {
+        s.chunks.push_back(s.stream.size());
+    }
+
+    return s;
+}
+
+
+struct Result {
+    std::string scenario;
+    std::string path;
+    size_t frames;
+    size_t delivered;
+    double nsPerFrame;
+    double mbPerSecond;
+    size_t allocations;
+};
+
+/// @brief Best of runs decoding the whole stream through a manager bound straight to the memory transport
+template <typename Config> Result Run(const Scenario& scenario, const char* path, bool spans, int runs) {
+    MemoryTransport transport(scenario.stream, scenario.chunks);
+    transport.spans = spans;
+
+    pckt::PacketManager<Config, MemoryTransport> manager(transport);
+    manager.Callback(pckt::Type::DataPacket, Handler);
+
+    Result r;
+    r.scenario = scenario.name;
+    r.path = path;
+    r.frames = scenario.frames;
+    r.nsPerFrame = 1e30;
+    r.allocations = 0;
+
+    for (int run = 0; run < runs; run++) {
+        transport.Rewind();
+        delivered = 0;
+        const size_t allocated = allocations;
+
+        const auto start = std::chrono::steady_clock::now();
+        while (transport.available()) manager.Update();
+        const auto elapsed = std::chrono::steady_clock::now() - start;
+
+        r.allocations += allocations - allocated;
+
+        const double ns = std::chrono::duration<double, std::nano>(elapsed).count();
+        if (ns / scenario.frames < r.nsPerFrame) {
+            r.nsPerFrame = ns / scenario.frames;
+            r.mbPerSecond = (double)scenario.stream.size() / ns * 1e3;
+        }
+    }
+
+    r.delivered = delivered;
+    return r;
+}
+
+
+void WriteCsv(std::ostream& out, const std::vector<Result>& results) {
+    out << "scenario,path,frames,delivered,ns_per_frame,mb_per_s,allocations\n";
+    for (const Result& r : results) {
+        out << r.scenario << "," << r.path << "," << r.frames << "," << r.delivered << ","
+            << std::fixed << std::setprecision(3) << r.nsPerFrame << "," << r.mbPerSecond << "," << r.allocations << "\n";
+    }
+}
+
+std::vector<Result> ReadCsv(std::istream& in) {
+    std::vector<Result> results;
+    std::string line;
+    std::getline(in, line);
+
+    while (std::getline(in, line)) {
+        std::stringstream row(line);
+        std::string field[7];
+        for (int f = 0; f < 7; f++) std::getline(row, field[f], ',');
+
+        Result r;
+        r.scenario = field[0];
+        r.path = field[1];
+        r.frames = strtoul(field[2].c_str(), nullptr, 10);
+        r.delivered = strtoul(field[3].c_str(), nullptr, 10);
+        r.nsPerFrame = strtod(field[4].c_str(), nullptr);
+        r.mbPerSecond = strtod(field[5].c_str(), nullptr);
+        r.allocations = strtoul(field[6].c_str(), nullptr, 10);
+        results.push_back(r);
+    }
+
+    return results;
+}
+
+
+int main(int argc, char** argv) {
+    const char* out = nullptr;
+    const char* baseline = nullptr;
+    double tolerance = 10.0;
+
+    for (int i = 1; i + 1 < argc; i += 2) {
+        if (!strcmp(argv[i], "--out")) out = argv[i+1];
+        else if (!strcmp(argv[i], "--baseline")) baseline = argv[i+1];
+        else if (!strcmp(argv[i], "--tolerance")) tolerance = strtod(argv[i+1], nullptr);
+    }
+
+    const size_t frames = 200000;
+    const int runs = 15;
+
+    const Scenario scenarios[] = {
+        Build("clean", Damage::None, frames, 1),
+        Build("noise", Damage::Noise, frames, 2),
+        Build("checksum", Damage::Checksum, frames, 3),
+        Build("split", Damage::Split, frames, 4),
+        Build("payload", Damage::Payload, frames, 5),
+    };
+
+    std::vector<Result> results;
+    for (const Scenario& s : scenarios) {
+        results.push_back(Run<pckt::DefaultConfig>(s, "read", false, runs));
+        results.push_back(Run<BatchConfig>(s, "batch", false, runs));
+        results.push_back(Run<pckt::DefaultConfig>(s, "span", true, runs));
+    }
+
+    std::vector<Result> base;
+    if (baseline) {
+        std::ifstream in(baseline);
+        if (!in) {
+            std::cerr << "can't read " << baseline << "\n";
+            return 2;
+        }
+        base = ReadCsv(in);
+    }
+
+    std::cout << std::left << std::setw(10) << "scenario" << std::setw(8) << "path" << std::right
+              << std::setw(12) << "delivered" << std::setw(12) << "ns/frame" << std::setw(10) << "MB/s" << std::setw(8) << "allocs";
+    if (baseline) std::cout << std::setw(10) << "vs base";
+    std::cout << "\n";
+
+    bool regressed = false;
+    for (const Result& r : results) {
+        std::cout << std::left << std::setw(10) << r.scenario << std::setw(8) << r.path << std::right
+                  << std::setw(12) << r.delivered << std::fixed << std::setprecision(2)
+                  << std::setw(12) << r.nsPerFrame << std::setw(10) << r.mbPerSecond << std::setw(8) << r.allocations;
+
+        for (const Result& b : base) {
+            if (b.scenario != r.scenario || b.path != r.path) continue;
+
+            const double change = 100.0 * (r.nsPerFrame - b.nsPerFrame) / b.nsPerFrame;
+            std::cout << std::setw(9) << std::showpos << change << std::noshowpos << "%";
+            if (change > tolerance) {
+                std::cout << "  slower";
+                regressed = true;
+            }
+        }
+        std::cout << "\n";
+    }
+
+    if (out) {
+        std::ofstream file(out);
+        WriteCsv(file, results);
+    }
+
+    return regressed ? 1 : 0;
+}
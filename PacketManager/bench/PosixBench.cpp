@@ -0,0 +1,133 @@
+#include "../src/PacketManager.hpp"
+#include "../src/PosixTransport.hpp"
+#include "../src/EventLoop.hpp"
+#include <cstdlib>
+#include <cstring>
+#include <iostream>
+#include <iomanip>
+#include <thread>
+#include <poll.h>
+#include <time.h>
+
+// build: g++ -std=c++11 -O2 -pthread bench/PosixBench.cpp -o posix_bench
+//
+// posix_bench [--frames 2000000]
+//   a sender thread writes frames as fast as the fd takes them while the receiver decodes them, driven by an
+//   EventLoop or by calling Update in a loop. Reports frames / s of wall time and frames per cpu second of the
+//   receiver and of both threads, i.e. frames / s per core. UDP may drop frames when the receiver falls behind
+
+/// @brief Sender side, frames are queued and written 4 KiB at a time
+struct SendConfig : public pckt::DefaultConfig {
+    static constexpr size_t TX_QUEUE_SIZE = 4096;
+};
+
+/// @brief Every datagram of a full tx queue must fit the receive buffer
+using RxTransport = trns::FdTransport<2*SendConfig::TX_QUEUE_SIZE>;
+using TxTransport = trns::FdTransport<64>;
+
+static size_t delivered = 0;
+static void Handler(const pckt::Packet<>& packet) { delivered += packet.payload[0] != 0xFF; }
+
+static double CpuSeconds(clockid_t clock) {
+    timespec t;
+    clock_gettime(clock, &t);
+    return (double)t.tv_sec + (double)t.tv_nsec * 1e-9;
+}
+
+static void Send(int fd, size_t frames, double& cpu) {
+    TxTransport transport(fd, false);
+    pckt::PacketManager<SendConfig, TxTransport> manager(transport);
+    uint8_t payload[pckt::DefaultConfig::MAX_PAYLOAD_SIZE] = {};
+
+    const double start = CpuSeconds(CLOCK_THREAD_CPUTIME_ID);
+    pollfd writable = { fd, POLLOUT, 0 };
+
+    for (size_t i = 0; i < frames; i++) {
+        payload[0] = (uint8_t)(i & 0x7F);
+        while (manager.Send(pckt::Type::DataPacket, payload, sizeof(payload)) == pckt::SendStatus::WouldBlock) {
+            poll(&writable, 1, 10);
+        }
+    }
+
+    while (manager.Flush() != pckt::SendStatus::Sent) poll(&writable, 1, 10);
+    cpu = CpuSeconds(CLOCK_THREAD_CPUTIME_ID) - start;
+}
+
+/// @brief Runs frames from txFd to rxFd, closes both
+static void Report(const char* name, int txFd, int rxFd, size_t frames, bool spin) {
+    if (txFd < 0 || rxFd < 0) {
+        std::cout << std::left << std::setw(28) << name << "unavailable (" << strerror(errno) << ")\n";
+        if (txFd >= 0) close(txFd);
+        if (rxFd >= 0) close(rxFd);
+        return;
+    }
+
+    RxTransport transport(rxFd);
+    pckt::PacketManager<pckt::DefaultConfig, RxTransport> manager(transport);
+    manager.Callback(pckt::Type::DataPacket, Handler);
+    trns::EventLoop<1> loop(100);
+    loop.Add(rxFd, manager);
+    delivered = 0;
+
+    const auto start = std::chrono::steady_clock::now();
+    const double cpuStart = CpuSeconds(CLOCK_THREAD_CPUTIME_ID);
+
+    double txCpu = 0;
+    std::thread sender(Send, txFd, frames, std::ref(txCpu));
+
+    // gives up once nothing arrived for a while, UDP may have dropped the rest
+    auto last = start;
+    while (delivered < frames && std::chrono::steady_clock::now() - last < std::chrono::milliseconds(500)) {
+        const size_t before = delivered;
+        if (spin) manager.Update();
+        else loop.Poll(100);
+        if (delivered != before) last = std::chrono::steady_clock::now();
+    }
+
+    const double rxCpu = CpuSeconds(CLOCK_THREAD_CPUTIME_ID) - cpuStart;
+    sender.join();
+    const double wall = std::chrono::duration<double>(last - start).count();
+    close(txFd);
+
+    std::cout << std::left << std::setw(28) << name << std::right << std::fixed << std::setprecision(2)
+              << std::setw(12) << delivered / wall / 1e6 << std::setw(12) << delivered / rxCpu / 1e6
+              << std::setw(12) << delivered / (rxCpu + txCpu) / 1e6 << std::setw(11) << 100.0 * delivered / frames << "%\n";
+}
+
+int main(int argc, char** argv) {
+    size_t frames = 2000000;
+    for (int i = 1; i + 1 < argc; i += 2) {
+        if (!strcmp(argv[i], "--frames")) frames = strtoul(argv[i+1], nullptr, 10);
+    }
+
+    std::cout << frames << " frames of " << sizeof(pckt::Packet<>) << " bytes, million frames / s\n"
+              << std::left << std::setw(28) << "link" << std::right << std::setw(12) << "wall"
+              << std::setw(12) << "rx core" << std::setw(12) << "per core" << std::setw(12) << "delivered" << "\n";
+
+    int pair[2];
+    if (socketpair(AF_UNIX, SOCK_STREAM, 0, pair) != 0) pair[0] = pair[1] = -1;
+    Report("unix stream, event loop", pair[0], pair[1], frames, false);
+
+    if (socketpair(AF_UNIX, SOCK_STREAM, 0, pair) != 0) pair[0] = pair[1] = -1;
+    Report("unix stream, busy polling", pair[0], pair[1], frames, true);
+
+    if (socketpair(AF_UNIX, SOCK_DGRAM, 0, pair) != 0) pair[0] = pair[1] = -1;
+    Report("unix datagram, event loop", pair[0], pair[1], frames, false);
+
+    const int master = posix_openpt(O_RDWR | O_NOCTTY);
+    int slave = master >= 0 && grantpt(master) == 0 && unlockpt(master) == 0 ? open(ptsname(master), O_RDWR | O_NOCTTY) : -1;
+    if (slave >= 0 && !trns::posix::MakeRaw(slave, 0)) {
+        close(slave);
+        slave = -1;
+    }
+    Report("pty, event loop", slave, master, frames, false);
+
+    const int rx = trns::posix::Udp(47821, "127.0.0.1", 47820);
+    Report("udp loopback, event loop", trns::posix::Udp(47820, "127.0.0.1", 47821), rx, frames, false);
+
+    const int listener = trns::posix::TcpListen("127.0.0.1", 47822);
+    const int client = listener >= 0 ? trns::posix::TcpConnect("127.0.0.1", 47822) : -1;
+    const int server = client >= 0 ? trns::posix::Accept(listener) : -1;
+    if (listener >= 0) close(listener);
+    Report("tcp loopback, event loop", client, server, frames, false);
+}
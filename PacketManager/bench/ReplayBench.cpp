@@ -0,0 +1,109 @@
+#include "../src/PacketManager.hpp"
+#include "../src/Capture.hpp"
+#include <cstdlib>
+#include <cstring>
+#include <iostream>
+#include <iomanip>
+#include <string>
+#include <vector>
+
+// build: g++ -std=c++11 -O2 bench/ReplayBench.cpp -o replay_bench
+//
+// replay_bench [--mb 256] [--dir /tmp]
+//   captures mb MiB of frames as if they had been read 64 bytes, 1 KiB and 64 KiB at a time, then replays each
+//   log as fast as possible through a manager bound straight to the replay transport. Reports GB/s of stream
+//   ingested and million frames / s, best of 5 runs with the log already in the page cache
+
+struct VariableConfig : public pckt::DefaultConfig {
+    static constexpr size_t MAX_PAYLOAD_SIZE = 64;
+    static constexpr bool VARIABLE_LENGTH = true;
+    using Checksum = pckt::chk::Crc16Ccitt;
+};
+
+static size_t delivered = 0;
+template <typename Packet> static void Handler(const Packet& packet) { delivered += packet.payload[0] != 0xFF; }
+
+/// @brief Fixed seed stream of frames of every length
+template <typename Config> static std::vector<uint8_t> Stream(size_t bytes, size_t& frames) {
+    pckt::Packet<Config> frame;
+    std::vector<uint8_t> stream;
+    stream.reserve(bytes + sizeof(frame));
+    frames = 0;
+
+    while (stream.size() < bytes) {
+        const size_t len = frames % (Config::MAX_PAYLOAD_SIZE + 1);
+        frame.magic = Config::MAGIC_NUM;
+        frame.type = (uint8_t)pckt::Type::DataPacket;
+        frame.flags = 0;
+        frame.SetPayloadLength(len);
+        for (size_t b = 0; b < len; b++) frame.payload[b] = (uint8_t)(frames + b) & 0x7F;
+
+        const size_t size = frame.FrameSize();
+        const typename Config::Checksum::Type checksum = Config::Checksum::Compute(frame.self(), size - sizeof(checksum));
+        memcpy(frame.self() + size - sizeof(checksum), &checksum, sizeof(checksum));
+
+        stream.insert(stream.end(), frame.self(), frame.self() + size);
+        frames++;
+    }
+
+    return stream;
+}
+
+template <typename Config> static void Report(const char* name, const std::string& path, const std::vector<uint8_t>& stream, size_t frames, size_t chunk) {
+    {
+        trns::CaptureLog<> log(path.c_str());
+        for (size_t at = 0; at < stream.size(); at += chunk) {
+            log.Record(false, stream.data() + at, chunk < stream.size() - at ? chunk : stream.size() - at);
+        }
+
+        if (!log.Flush()) {
+            std::cout << name << ": couldn't write " << path << "\n";
+            return;
+        }
+    }
+
+    double best = 1e30;
+    for (int run = 0; run < 5; run++) {
+        trns::ReplayTransport replay(path.c_str());
+        pckt::PacketManager<Config, trns::ReplayTransport> manager(replay);
+        manager.Callback(pckt::Type::DataPacket, Handler<pckt::Packet<Config>>);
+        delivered = 0;
+
+        const auto start = std::chrono::steady_clock::now();
+        while (!replay.Done()) manager.Update();
+        const double elapsed = std::chrono::duration<double>(std::chrono::steady_clock::now() - start).count();
+
+        if (delivered != frames) std::cerr << name << ": delivered " << delivered << "/" << frames << " frames\n";
+        if (elapsed < best) best = elapsed;
+    }
+
+    unlink(path.c_str());
+
+    std::cout << std::left << std::setw(32) << name << std::right << std::fixed << std::setprecision(2)
+              << std::setw(10) << stream.size() / best / 1e9 << std::setw(12) << frames / best / 1e6 << "\n";
+}
+
+int main(int argc, char** argv) {
+    size_t mb = 256;
+    std::string dir = "/tmp";
+    for (int i = 1; i + 1 < argc; i += 2) {
+        if (!strcmp(argv[i], "--mb")) mb = strtoul(argv[i+1], nullptr, 10);
+        else if (!strcmp(argv[i], "--dir")) dir = argv[i+1];
+    }
+
+    const std::string path = dir + "/replay_bench_" + std::to_string(getpid()) + ".log";
+
+    std::cout << mb << " MiB of frames\n" << std::left << std::setw(32) << "stream, chunks" << std::right
+              << std::setw(10) << "GB/s" << std::setw(12) << "Mframes/s" << "\n";
+
+    size_t frames;
+    const std::vector<uint8_t> fixed = Stream<pckt::DefaultConfig>(mb << 20, frames);
+    Report<pckt::DefaultConfig>("13 byte frames, 64 B", path, fixed, frames, 64);
+    Report<pckt::DefaultConfig>("13 byte frames, 1 KiB", path, fixed, frames, 1024);
+    Report<pckt::DefaultConfig>("13 byte frames, 64 KiB", path, fixed, frames, 65536);
+
+    const std::vector<uint8_t> variable = Stream<VariableConfig>(mb << 20, frames);
+    Report<VariableConfig>("6-70 byte frames, 64 B", path, variable, frames, 64);
+    Report<VariableConfig>("6-70 byte frames, 1 KiB", path, variable, frames, 1024);
+    Report<VariableConfig>("6-70 byte frames, 64 KiB", path, variable, frames, 65536);
+}
@@ -0,0 +1,198 @@
+#include "Bench.hpp"
+#include "../src/PacketManager.hpp"
+#include <cstdlib>
+#include <cstring>
+#include <iostream>
+#include <iomanip>
+#include <vector>
+
+// build: g++ -std=c++11 -O2 bench/ResyncBench.cpp -o resync_bench
+//
+// resync_bench [--bound 2]
+//   decodes streams built so that as many offsets as possible look like a frame start, for frame sizes
+//   from 13 to 255 bytes and streams from 64 KiB to 1 MiB. Resync work that is linear in the bytes
+//   received keeps ns / byte flat along both axes, exits 1 if the largest frame size costs more than
+//   bound times the smallest per byte. Only fixed length Fletcher16 frames resync linearly, crc16 and
+//   variable length frames are measured alongside them to show what a false start costs without it
+//   and aren't held to the bound
+
+/// @brief Replays a stream from memory, as spans or reads of whatever size is asked for
+struct MemoryTransport : public pckt::StaticTransport {
+    public:
+    MemoryTransport(const std::vector<uint8_t>& stream) : stream(stream) {}
+
+    inline int read(uint8_t* data, size_t len) {
+        const size_t left = stream.size() - head;
+        if (len > left) len = left;
+        memcpy(data, stream.data() + head, len);
+        head += len;
+        return (int)len;
+    }
+
+    inline size_t write(const uint8_t* data, size_t len) { (void)data; return len; }
+
+    inline bool available() { return head < stream.size(); }
+
+    inline size_t peek(const uint8_t*& data) {
+        data = stream.data() + head;
+        return spans ? stream.size() - head : 0;
+    }
+
+    inline void consume(size_t len) { head += len; }
+
+    const std::vector<uint8_t>& stream;
+    size_t head = 0;
+    bool spans = false;
+};
+
+template <size_t Payload, size_t Batch, typename C = pckt::chk::Fletcher16, bool Variable = false>
+struct SizedConfig : public pckt::DefaultConfig {
+    static constexpr size_t MAX_PAYLOAD_SIZE = Payload;
+    static constexpr size_t RX_BATCH_SIZE = Batch;
+    static constexpr bool VARIABLE_LENGTH = Variable;
+    using Checksum = C;
+};
+
+static size_t delivered = 0;
+template <typename P> static void Handler(const P& packet) { (void)packet; delivered++; }
+
+
+enum class Pattern { Magic, Headers };
+
+/// @brief Bytes that are all candidate frame starts, or a plausible header every 3 bytes, ended by one real frame
+template <typename Config> std::vector<uint8_t> Build(Pattern pattern, size_t bytes) {
+    std::vector<uint8_t> stream(bytes);
+    for (size_t i = 0; i < bytes; i++) {
+        if (pattern == Pattern::Magic) stream[i] = Config::MAGIC_NUM;
+        else stream[i] = i%3 == 0 ? Config::MAGIC_NUM : i%3 == 1 ? (uint8_t)pckt::Type::DataPacket : 0;
+    }
+
+    pckt::Packet<Config> frame;
+    frame.type = (uint8_t)pckt::Type::DataPacket;
+    frame.flags = 0;
+    frame.SetPayloadLength(Config::MAX_PAYLOAD_SIZE);
+    memset(frame.payload, 0, sizeof(frame.payload));
+    frame.checksum = Config::Checksum::Compute(frame.self(), frame.FrameSize() - sizeof(frame.checksum));
+    stream.insert(stream.end(), frame.self(), frame.self() + frame.FrameSize());
+
+    return stream;
+}
+
+/// @brief Best of runs, ns per byte of decoding the whole stream
+template <typename Config> double NsPerByte(const std::vector<uint8_t>& stream, bool spans, int runs) {
+    MemoryTransport transport(stream);
+    transport.spans = spans;
+
+    pckt::PacketManager<Config, MemoryTransport> manager(transport);
+    manager.Callback(pckt::Type::DataPacket, Handler);
+
+    double best = 1e30;
+    for (int run = 0; run < runs; run++) {
+        transport.head = 0;
+        delivered = 0;
+
+        const auto start = std::chrono::steady_clock::now();
+        while (transport.available()) manager.Update();
+        const auto elapsed = std::chrono::steady_clock::now() - start;
+
+        const double ns = std::chrono::duration<double, std::nano>(elapsed).count() / stream.size();
+        if (ns < best) best = ns;
+    }
+
+    // the real frame at the end must survive the garbage in front of it
+    if (delivered != 1) std::cerr << "lost the frame after the garbage\n";
+    return best;
+}
+
+
+struct Row {
+    const char* frames;
+    const char* pattern;
+    const char* path;
+    size_t frameSize;
+    size_t bytes;
+    double nsPerByte;
+};
+
+template <size_t Payload, typename C = pckt::chk::Fletcher16, bool Variable = false>
+void Measure(std::vector<Row>& rows, const char* frames, const size_t* sizes, size_t sizeCount, int runs) {
+    using Read = SizedConfig<Payload, 0, C, Variable>;
+    using Batch = SizedConfig<Payload, 64, C, Variable>;
+
+    const struct { Pattern pattern; const char* name; } patterns[] = {
+        { Pattern::Magic, "magic" },
+        { Pattern::Headers, "headers" },
+    };
+
+    for (const auto& p : patterns) {
+        for (size_t s = 0; s < sizeCount; s++) {
+            const std::vector<uint8_t> stream = Build<Read>(p.pattern, sizes[s]);
+            const size_t frameSize = sizeof(pckt::Packet<Read>);
+
+            rows.push_back({ frames, p.name, "read", frameSize, sizes[s], NsPerByte<Read>(stream, false, runs) });
+            rows.push_back({ frames, p.name, "batch", frameSize, sizes[s], NsPerByte<Batch>(stream, false, runs) });
+            rows.push_back({ frames, p.name, "span", frameSize, sizes[s], NsPerByte<Read>(stream, true, runs) });
+        }
+    }
+}
+
+
+int main(int argc, char** argv) {
+    double bound = 2.0;
+    for (int i = 1; i + 1 < argc; i += 2) {
+        if (!strcmp(argv[i], "--bound")) bound = strtod(argv[i+1], nullptr);
+    }
+
+    const size_t sizes[] = { 64 << 10, 256 << 10, 1 << 20 };
+    const size_t sizeCount = sizeof(sizes) / sizeof(sizes[0]);
+    const int runs = 7;
+
+    std::vector<Row> rows;
+    Measure<8>(rows, "fletcher", sizes, sizeCount, runs);
+    Measure<32>(rows, "fletcher", sizes, sizeCount, runs);
+    Measure<128>(rows, "fletcher", sizes, sizeCount, runs);
+    Measure<250>(rows, "fletcher", sizes, sizeCount, runs);
+
+    // every false start summed from scratch
+    Measure<8, pckt::chk::Crc16Ccitt>(rows, "crc16", sizes, sizeCount, runs);
+    Measure<250, pckt::chk::Crc16Ccitt>(rows, "crc16", sizes, sizeCount, runs);
+    Measure<8, pckt::chk::Fletcher16, true>(rows, "variable", sizes, sizeCount, runs);
+    Measure<250, pckt::chk::Fletcher16, true>(rows, "variable", sizes, sizeCount, runs);
+
+    std::cout << std::left << std::setw(10) << "frames" << std::setw(10) << "pattern" << std::setw(8) << "path" << std::right
+              << std::setw(8) << "frame" << std::setw(10) << "bytes" << std::setw(10) << "ns/byte" << "\n";
+
+    for (const Row& r : rows) {
+        std::cout << std::left << std::setw(10) << r.frames << std::setw(10) << r.pattern << std::setw(8) << r.path << std::right
+                  << std::setw(8) << r.frameSize << std::setw(10) << r.bytes
+                  << std::fixed << std::setprecision(2) << std::setw(10) << r.nsPerByte << "\n";
+    }
+
+    // per frames, pattern and path, the largest stream of the largest frames against that of the smallest frames,
+    // only the fletcher frames resync linearly and are held to the bound
+    bool superlinear = false;
+    for (const Row& small : rows) {
+        if (small.bytes != sizes[sizeCount-1]) continue;
+
+        const Row* large = &small;
+        bool smallest = true;
+        for (const Row& r : rows) {
+            if (r.bytes != small.bytes || strcmp(r.frames, small.frames) || strcmp(r.pattern, small.pattern) || strcmp(r.path, small.path)) continue;
+            if (r.frameSize < small.frameSize) smallest = false;
+            if (r.frameSize > large->frameSize) large = &r;
+        }
+
+        if (!smallest || large == &small) continue;
+
+        const double ratio = large->nsPerByte / small.nsPerByte;
+        std::cout << small.frames << " " << small.pattern << " " << small.path << ": " << std::setprecision(2) << ratio
+                  << "x per byte from " << small.frameSize << " to " << large->frameSize << " byte frames";
+        if (ratio > bound && !strcmp(small.frames, "fletcher")) {
+            std::cout << "  over bound";
+            superlinear = true;
+        }
+        std::cout << "\n";
+    }
+
+    return superlinear ? 1 : 0;
+}
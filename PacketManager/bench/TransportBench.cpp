@@ -0,0 +1,118 @@
+#include "Bench.hpp"
+#include "../src/PacketManager.hpp"
+#include <iostream>
+#include <iomanip>
+#include <vector>
+
+// build: g++ -std=c++11 -O2 bench/TransportBench.cpp -o transport_bench
+
+/// @brief Replays a prepared stream of frames from memory, as cheap as a transport gets so the dispatch cost shows
+struct MemoryTransport final : public pckt::Transport {
+    public:
+    MemoryTransport(const std::vector<uint8_t>& stream) : stream(stream) {}
+
+    int read(uint8_t* data, size_t len) override {
+        const size_t left = stream.size() - head;
+        if (len > left) len = left;
+        memcpy(data, stream.data() + head, len);
+        head += len;
+        return (int)len;
+    }
+
+    size_t write(const uint8_t* data, size_t len) override { (void)data; return len; }
+
+    bool available() override { return head < stream.size(); }
+
+    size_t peek(const uint8_t*& data) override {
+        data = stream.data() + head;
+        if (!spans) return 0;
+
+        const size_t left = stream.size() - head;
+        return left < maxSpan ? left : maxSpan;
+    }
+
+    void consume(size_t len) override { head += len; }
+
+    const std::vector<uint8_t>& stream;
+    size_t head = 0;
+    bool spans = false;
+    size_t maxSpan = 64;
+};
+
+struct BatchConfig : public pckt::DefaultConfig {
+    static constexpr size_t RX_BATCH_SIZE = 64;
+};
+
+static size_t delivered = 0;
+static void Handler(const pckt::Packet<>& packet) { delivered += packet.payload[0] != 0xFF; }
+static void BatchHandler(const pckt::Packet<BatchConfig>& packet) { delivered += packet.payload[0] != 0xFF; }
+
+template <typename Config> void SetHandler(pckt::PacketManager<Config, pckt::Transport>& m) { m.Callback(pckt::Type::DataPacket, Handler); }
+template <typename Config> void SetHandler(pckt::PacketManager<Config, MemoryTransport>& m) { m.Callback(pckt::Type::DataPacket, Handler); }
+void SetHandler(pckt::PacketManager<BatchConfig, pckt::Transport>& m) { m.Callback(pckt::Type::DataPacket, BatchHandler); }
+void SetHandler(pckt::PacketManager<BatchConfig, MemoryTransport>& m) { m.Callback(pckt::Type::DataPacket, BatchHandler); }
+
+/// @brief ns per frame decoding the whole stream once
+template <typename Manager> double NsPerFrame(Manager& manager, MemoryTransport& memory, size_t frames) {
+    memory.head = 0;
+    delivered = 0;
+
+    const auto start = std::chrono::steady_clock::now();
+    while (memory.head < memory.stream.size()) manager.Update();
+    const auto elapsed = std::chrono::steady_clock::now() - start;
+
+    if (delivered != frames) {
+        std::cerr << "delivered " << delivered << "/" << frames << " frames\n";
+    }
+
+    return std::chrono::duration<double, std::nano>(elapsed).count() / (double)frames;
+}
+
+template <typename Config> void Report(const char* name, MemoryTransport& memory, size_t frames) {
+    // the virtual path sees only a Transport*, as it would behind a pointer handed over from another translation unit
+    pckt::Transport& virt = *bench::Opaque<pckt::Transport>(&memory);
+
+    pckt::PacketManager<Config, pckt::Transport> virtualManager(virt);
+    pckt::PacketManager<Config, MemoryTransport> staticManager(memory);
+    SetHandler(virtualManager);
+    SetHandler(staticManager);
+
+    // interleaved so both see the same machine state, best of each
+    double v = 1e30, st = 1e30;
+    for (int run = 0; run < 51; run++) {
+        const double a = NsPerFrame(virtualManager, memory, frames);
+        const double b = NsPerFrame(staticManager, memory, frames);
+        if (a < v) v = a;
+        if (b < st) st = b;
+    }
+
+    std::cout << std::left << std::setw(24) << name << std::right << std::fixed << std::setprecision(2)
+              << std::setw(12) << v << std::setw(12) << st << std::setw(11) << v / st << "x\n";
+}
+
+int main() {
+    const size_t frames = 100000;
+
+    // a fixed stream of default frames
+    pckt::Packet<> frame;
+    std::vector<uint8_t> stream;
+    stream.reserve(frames * sizeof(frame));
+    for (size_t i = 0; i < frames; i++) {
+        frame.type = (uint8_t)pckt::Type::DataPacket;
+        frame.flags = 0;
+        for (size_t b = 0; b < sizeof(frame.payload); b++) frame.payload[b] = (uint8_t)(i + b) & 0x7F;
+        frame.checksum = pckt::DefaultConfig::Checksum::Compute(frame.self(), sizeof(frame) - sizeof(frame.checksum));
+        stream.insert(stream.end(), frame.self(), frame.self() + sizeof(frame));
+    }
+
+    MemoryTransport memory(stream);
+
+    std::cout << "ns / frame\n" << std::left << std::setw(24) << "path" << std::right
+              << std::setw(12) << "virtual" << std::setw(12) << "static" << std::setw(12) << "speedup" << "\n";
+
+    Report<pckt::DefaultConfig>("read, frame at a time", memory, frames);
+    Report<BatchConfig>("read, 64 byte batches", memory, frames);
+
+    memory.spans = true;
+    Report<pckt::DefaultConfig>("spans, 64 bytes", memory, frames);
+}
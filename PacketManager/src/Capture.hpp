@@ -0,0 +1,277 @@
+#pragma once
+#include "Platform.hpp"
+#include "Transport.hpp"
+
+#if defined(__linux__)
+#include <errno.h>
+#include <fcntl.h>
+#include <unistd.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+
+namespace trns {
+
+    /// @brief Capture log layout
+    ///
+    /// An 8 byte header, "PCKTCAP" and the version, then one record per chunk read or written: the microseconds
+    /// since the previous record (uint32), the chunk length with the top bit set for written chunks (uint32), both
+    /// little endian, and the chunk's bytes
+    namespace capture {
+        static constexpr uint8_t MAGIC[8] = { 'P', 'C', 'K', 'T', 'C', 'A', 'P', 1 };
+        static constexpr size_t RECORD_HEADER = 8;
+        static constexpr uint32_t WRITTEN = 0x80000000u;
+
+        inline void Store32(uint8_t* out, uint32_t v) {
+            out[0] = (uint8_t)v;
+            out[1] = (uint8_t)(v >> 8);
+            out[2] = (uint8_t)(v >> 16);
+            out[3] = (uint8_t)(v >> 24);
+        }
+
+        inline uint32_t Load32(const uint8_t* in) {
+            return (uint32_t)in[0] | ((uint32_t)in[1] << 8) | ((uint32_t)in[2] << 16) | ((uint32_t)in[3] << 24);
+        }
+    } // namespace capture
+
+
+    /// @brief Append only capture log file, records are buffered and written N bytes at a time
+    template <size_t N = 65536> struct CaptureLog {
+        public:
+        /// @param path Log file, truncated
+        CaptureLog(const char* path) : used(0), last(pckt::Micros()) {
+            fd = ::open(path, O_WRONLY | O_CREAT | O_TRUNC | O_CLOEXEC, 0644);
+            Append(capture::MAGIC, sizeof(capture::MAGIC));
+        }
+
+        ~CaptureLog() {
+            Flush();
+            if (fd >= 0) ::close(fd);
+        }
+
+        CaptureLog(const CaptureLog&) = delete;
+        CaptureLog& operator=(const CaptureLog&) = delete;
+
+
+        /// @brief Appends a chunk stamped with the time since the previous one
+        /// @param written The chunk was written to the transport rather than read from it
+        inline void Record(bool written, const uint8_t* data, size_t len) {
+            if (!len) return;
+
+            const unsigned long now = pckt::Micros();
+            const unsigned long delta = now - last;
+            last = now;
+
+            uint8_t header[capture::RECORD_HEADER];
+            capture::Store32(header, delta > 0xFFFFFFFFul ? 0xFFFFFFFFu : (uint32_t)delta);
+            capture::Store32(header + 4, (uint32_t)len | (written ? capture::WRITTEN : 0));
+            Append(header, sizeof(header));
+            Append(data, len);
+        }
+
+        /// @brief Writes out whatever is buffered
+        /// @return False if the file couldn't be opened or written
+        inline bool Flush() {
+            size_t done = 0;
+            while (fd >= 0 && done < used) {
+                const ssize_t n = ::write(fd, buffer + done, used - done);
+                if (n < 0 && errno == EINTR) continue;
+                if (n <= 0) break;
+                done += (size_t)n;
+            }
+
+            const bool ok = fd >= 0 && done == used;
+            used = 0;
+            return ok;
+        }
+
+        inline bool IsOpen() const { return fd >= 0; }
+
+
+        private:
+        int fd;
+        uint8_t buffer[N];
+        size_t used;
+        unsigned long last;
+
+        inline void Append(const uint8_t* data, size_t len) {
+            while (len) {
+                if (used == N) Flush();
+
+                const size_t n = N - used < len ? N - used : len;
+                memcpy(buffer + used, data, n);
+                used += n;
+                data += n;
+                len -= n;
+            }
+        }
+    }; // struct CaptureLog
+
+
+    /// @brief Records every chunk read from and written to another transport into a CaptureLog, otherwise passes
+    /// everything through, spans included. Bytes read through spans are recorded as they are consumed
+    /// @tparam Inner Transport being recorded, Transport dispatches through the vtable, a final one inlines
+    template <typename Inner = pckt::Transport, typename Log = CaptureLog<>> struct CaptureTransport final : public pckt::Transport {
+        public:
+        CaptureTransport(Inner& inner, Log& log) : inner(inner), log(log), span(nullptr) {}
+
+        int read(uint8_t* data, size_t len) override {
+            const int n = inner.read(data, len);
+            if (n > 0) log.Record(false, data, (size_t)n);
+            return n;
+        }
+
+        size_t write(const uint8_t* data, size_t len) override {
+            const size_t n = inner.write(data, len);
+            log.Record(true, data, n);
+            return n;
+        }
+
+        bool available() override { return inner.available(); }
+
+        size_t peek(const uint8_t*& data) override {
+            const size_t n = inner.peek(data);
+            span = data;
+            return n;
+        }
+
+        void consume(size_t len) override {
+            log.Record(false, span, len);
+            inner.consume(len);
+        }
+
+
+        private:
+        Inner& inner;
+        Log& log;
+        const uint8_t* span; // last peek, what consume releases
+    }; // struct CaptureTransport
+
+
+    /// @brief Feeds the chunks a CaptureLog recorded as read back to a manager, straight out of the mapped file
+    ///
+    /// Every chunk is exposed as a span so replay costs no syscall or copy per chunk. As fast as possible by default,
+    /// in real time a chunk only becomes available once as much time has passed since the first as when it was
+    /// recorded. Writes are accepted and dropped
+    struct ReplayTransport final : public pckt::Transport {
+        public:
+        /// @param realtime Space chunks out as they were recorded
+        ReplayTransport(const char* path, bool realtime = false) : realtime(realtime), map(nullptr), size(0) {
+            Rewind();
+
+            const int fd = ::open(path, O_RDONLY | O_CLOEXEC);
+            if (fd < 0) return;
+
+            struct stat st;
+            if (fstat(fd, &st) == 0 && (size_t)st.st_size >= sizeof(capture::MAGIC)) {
+                void* m = mmap(nullptr, (size_t)st.st_size, PROT_READ, MAP_PRIVATE, fd, 0);
+                if (m != MAP_FAILED) {
+                    map = static_cast<const uint8_t*>(m);
+                    size = (size_t)st.st_size;
+                    madvise(m, size, MADV_SEQUENTIAL);
+                }
+            }
+
+            ::close(fd);
+
+            if (map && memcmp(map, capture::MAGIC, sizeof(capture::MAGIC)) != 0) {
+                munmap(const_cast<uint8_t*>(map), size);
+                map = nullptr;
+                size = 0;
+            }
+        }
+
+        ~ReplayTransport() {
+            if (map) munmap(const_cast<uint8_t*>(map), size);
+        }
+
+        ReplayTransport(const ReplayTransport&) = delete;
+        ReplayTransport& operator=(const ReplayTransport&) = delete;
+
+
+        int read(uint8_t* data, size_t len) override {
+            const uint8_t* span;
+            size_t n = peek(span);
+            if (n > len) n = len;
+
+            memcpy(data, span, n);
+            consume(n);
+            return (int)n;
+        }
+
+        size_t write(const uint8_t* data, size_t len) override { (void)data; return len; }
+
+        bool available() override {
+            if (!Next()) return false;
+            return !realtime || pckt::Micros() - startedAt >= due;
+        }
+
+        size_t peek(const uint8_t*& data) override {
+            const bool ready = available();
+            data = map + at;
+            return ready ? left : 0;
+        }
+
+        void consume(size_t len) override {
+            at += len;
+            left -= len;
+            replayed += len;
+        }
+
+
+        /// @brief Starts over from the first chunk, real time replay counts from now
+        inline void Rewind() {
+            at = sizeof(capture::MAGIC);
+            left = 0;
+            due = 0;
+            replayed = 0;
+            startedAt = pckt::Micros();
+        }
+
+        /// @brief The log was mapped and has the capture header
+        inline bool IsOpen() const { return map != nullptr; }
+
+        /// @brief Every chunk read has been replayed
+        inline bool Done() { return !Next(); }
+
+        /// @brief Bytes handed to the manager since the last Rewind
+        inline size_t Replayed() const { return replayed; }
+
+
+        private:
+        bool realtime;
+        const uint8_t* map;
+        size_t size;
+
+        size_t at; // next byte of the current chunk
+        size_t left; // bytes left in it
+        uint64_t due; // microseconds after the first chunk it was recorded at
+        size_t replayed;
+        unsigned long startedAt;
+
+        /// @brief Moves past finished chunks and written ones to the next chunk read, a chunk cut short by the end of
+        /// the file is replayed as far as it goes
+        /// @return False once there are none left
+        inline bool Next() {
+            while (!left) {
+                if (!map || size - at < capture::RECORD_HEADER) return false;
+
+                const uint32_t delta = capture::Load32(map + at);
+                const uint32_t lenDir = capture::Load32(map + at + 4);
+                at += capture::RECORD_HEADER;
+
+                // the first chunk's delta is from when the log was opened, not from another chunk
+                if (at > sizeof(capture::MAGIC) + capture::RECORD_HEADER) due += delta;
+
+                size_t len = lenDir & ~capture::WRITTEN;
+                if (len > size - at) len = size - at;
+
+                if (lenDir & capture::WRITTEN) at += len;
+                else left = len;
+            }
+
+            return true;
+        }
+    }; // struct ReplayTransport
+
+} // namespace trns
+#endif
@@ -0,0 +1,276 @@
+#pragma once
+#include <stdint.h>
+#include <stddef.h>
+
+#if defined(__AVR__)
+#include <avr/pgmspace.h>
+#define PCKT_PROGMEM PROGMEM
+#define PCKT_READ_WORD(addr) pgm_read_word(addr)
+#else
+#define PCKT_PROGMEM
+#define PCKT_READ_WORD(addr) (*(addr))
+#endif
+
+namespace pckt {
+namespace chk {
+
+    // Every checksum policy exposes the same static interface so the packet manager can
+    // accumulate a frame as bytes arrive and only finalize once the last byte lands
+    //
+    //  Type                             - value stored in the frame
+    //  State                            - running accumulator
+    //  Reset(State&)                    - starts a new frame
+    //  Update(State&, uint8_t)          - feeds a single byte
+    //  Update(State&, const uint8_t*, n)- feeds a run of bytes
+    //  Final(const State&)              - value to compare against / write into the frame
+    //  Compute(const uint8_t*, n)       - one shot helper
+    //  ROLLING                          - true if Drop(State&, uint8_t, n) can take the first byte of an n byte
+    //                                     run back out, which lets resync slide a sum along instead of redoing it
+
+
+    /// @brief Fletcher-16 with deferred reduction, bit for bit compatible with the original per-byte % 255
+    struct Fletcher16 {
+        public:
+        using Type = uint16_t;
+
+        struct State {
+            uint16_t sum1;
+            uint16_t sum2;
+            uint8_t pending;
+        }; // struct State
+
+        // sums start <= 255 after a reduction, sum2 stays within 16 bits for 21 more bytes
+        static constexpr uint8_t MAX_DEFERRED = 21;
+
+        static inline void Reset(State& s) {
+            s.sum1 = 0;
+            s.sum2 = 0;
+            s.pending = 0;
+        }
+
+        static inline void Update(State& s, uint8_t byte) {
+            s.sum1 += byte;
+            s.sum2 += s.sum1;
+
+            if (++s.pending == MAX_DEFERRED) {
+                Reduce(s);
+            }
+        }
+
+        static inline void Update(State& s, const uint8_t* data, size_t len) {
+            // finish the block a previous call left open
+            while (len && s.pending) {
+                Update(s, *data++);
+                len--;
+            }
+
+            // full blocks, no branch in the inner loop
+            while (len >= MAX_DEFERRED) {
+                for (uint8_t i = 0; i < MAX_DEFERRED; i++) {
+                    s.sum1 += data[i];
+                    s.sum2 += s.sum1;
+                }
+
+                Reduce(s);
+                data += MAX_DEFERRED;
+                len -= MAX_DEFERRED;
+            }
+
+            while (len--) { Update(s, *data++); }
+        }
+
+        static inline Type Final(const State& state) {
+            State s = state;
+            Reduce(s);
+
+            // 255 is congruent to 0, the original modulo never produced it
+            if (s.sum1 == 255) s.sum1 = 0;
+            if (s.sum2 == 255) s.sum2 = 0;
+
+            return (s.sum2 << 8) | s.sum1;
+        }
+
+        static inline Type Compute(const uint8_t* data, size_t len) {
+            State s;
+            Reset(s);
+            Update(s, data, len);
+            return Final(s);
+        }
+
+        static constexpr bool ROLLING = true;
+
+        /// @brief Removes the first byte of the len bytes summed so far, it added byte to sum1 and len*byte to sum2
+        static inline void Drop(State& s, uint8_t byte, size_t len) {
+            Reduce(s);
+            s.sum1 = Fold(s.sum1 + 255 - byte);
+            s.sum2 = Fold(s.sum2 + 255 - Fold(Fold((uint16_t)(len % 255) * byte)));
+        }
+
+        private:
+        /// @brief Folds the high byte into the low byte, 256 = 1 (mod 255) so no divide is needed
+        static inline uint16_t Fold(uint16_t v) { return (v & 0xFF) + (v >> 8); }
+
+        /// @brief Reduces both sums to [0, 255]
+        static inline void Reduce(State& s) {
+            s.sum1 = Fold(Fold(s.sum1));
+            s.sum2 = Fold(Fold(s.sum2));
+            s.pending = 0;
+        }
+    }; // struct Fletcher16
+
+
+    // inline variables need C++17, a template keeps the table header only on older toolchains
+    template <typename T> struct Crc16Table { static const uint16_t TABLE[256]; };
+    template <typename T> const uint16_t Crc16Table<T>::TABLE[256] PCKT_PROGMEM = {
+        0x0000, 0x1021, 0x2042, 0x3063, 0x4084, 0x50A5, 0x60C6, 0x70E7,
+        0x8108, 0x9129, 0xA14A, 0xB16B, 0xC18C, 0xD1AD, 0xE1CE, 0xF1EF,
+        0x1231, 0x0210, 0x3273, 0x2252, 0x52B5, 0x4294, 0x72F7, 0x62D6,
+        0x9339, 0x8318, 0xB37B, 0xA35A, 0xD3BD, 0xC39C, 0xF3FF, 0xE3DE,
+        0x2462, 0x3443, 0x0420, 0x1401, 0x64E6, 0x74C7, 0x44A4, 0x5485,
+        0xA56A, 0xB54B, 0x8528, 0x9509, 0xE5EE, 0xF5CF, 0xC5AC, 0xD58D,
+        0x3653, 0x2672, 0x1611, 0x0630, 0x76D7, 0x66F6, 0x5695, 0x46B4,
+        0xB75B, 0xA77A, 0x9719, 0x8738, 0xF7DF, 0xE7FE, 0xD79D, 0xC7BC,
+        0x48C4, 0x58E5, 0x6886, 0x78A7, 0x0840, 0x1861, 0x2802, 0x3823,
+        0xC9CC, 0xD9ED, 0xE98E, 0xF9AF, 0x8948, 0x9969, 0xA90A, 0xB92B,
+        0x5AF5, 0x4AD4, 0x7AB7, 0x6A96, 0x1A71, 0x0A50, 0x3A33, 0x2A12,
+        0xDBFD, 0xCBDC, 0xFBBF, 0xEB9E, 0x9B79, 0x8B58, 0xBB3B, 0xAB1A,
+        0x6CA6, 0x7C87, 0x4CE4, 0x5CC5, 0x2C22, 0x3C03, 0x0C60, 0x1C41,
+        0xEDAE, 0xFD8F, 0xCDEC, 0xDDCD, 0xAD2A, 0xBD0B, 0x8D68, 0x9D49,
+        0x7E97, 0x6EB6, 0x5ED5, 0x4EF4, 0x3E13, 0x2E32, 0x1E51, 0x0E70,
+        0xFF9F, 0xEFBE, 0xDFDD, 0xCFFC, 0xBF1B, 0xAF3A, 0x9F59, 0x8F78,
+        0x9188, 0x81A9, 0xB1CA, 0xA1EB, 0xD10C, 0xC12D, 0xF14E, 0xE16F,
+        0x1080, 0x00A1, 0x30C2, 0x20E3, 0x5004, 0x4025, 0x7046, 0x6067,
+        0x83B9, 0x9398, 0xA3FB, 0xB3DA, 0xC33D, 0xD31C, 0xE37F, 0xF35E,
+        0x02B1, 0x1290, 0x22F3, 0x32D2, 0x4235, 0x5214, 0x6277, 0x7256,
+        0xB5EA, 0xA5CB, 0x95A8, 0x8589, 0xF56E, 0xE54F, 0xD52C, 0xC50D,
+        0x34E2, 0x24C3, 0x14A0, 0x0481, 0x7466, 0x6447, 0x5424, 0x4405,
+        0xA7DB, 0xB7FA, 0x8799, 0x97B8, 0xE75F, 0xF77E, 0xC71D, 0xD73C,
+        0x26D3, 0x36F2, 0x0691, 0x16B0, 0x6657, 0x7676, 0x4615, 0x5634,
+        0xD94C, 0xC96D, 0xF90E, 0xE92F, 0x99C8, 0x89E9, 0xB98A, 0xA9AB,
+        0x5844, 0x4865, 0x7806, 0x6827, 0x18C0, 0x08E1, 0x3882, 0x28A3,
+        0xCB7D, 0xDB5C, 0xEB3F, 0xFB1E, 0x8BF9, 0x9BD8, 0xABBB, 0xBB9A,
+        0x4A75, 0x5A54, 0x6A37, 0x7A16, 0x0AF1, 0x1AD0, 0x2AB3, 0x3A92,
+        0xFD2E, 0xED0F, 0xDD6C, 0xCD4D, 0xBDAA, 0xAD8B, 0x9DE8, 0x8DC9,
+        0x7C26, 0x6C07, 0x5C64, 0x4C45, 0x3CA2, 0x2C83, 0x1CE0, 0x0CC1,
+        0xEF1F, 0xFF3E, 0xCF5D, 0xDF7C, 0xAF9B, 0xBFBA, 0x8FD9, 0x9FF8,
+        0x6E17, 0x7E36, 0x4E55, 0x5E74, 0x2E93, 0x3EB2, 0x0ED1, 0x1EF0,
+    };
+
+
+    /// @brief Table driven CRC-16/CCITT-FALSE (poly 0x1021, init 0xFFFF), table lives in flash on AVR
+    struct Crc16Ccitt {
+        public:
+        using Type = uint16_t;
+        using State = uint16_t;
+
+        static inline void Reset(State& s) { s = 0xFFFF; }
+
+        static inline void Update(State& s, uint8_t byte) {
+            s = (s << 8) ^ PCKT_READ_WORD(&Crc16Table<void>::TABLE[(uint8_t)((s >> 8) ^ byte)]);
+        }
+
+        static inline void Update(State& s, const uint8_t* data, size_t len) {
+            while (len--) { Update(s, *data++); }
+        }
+
+        static inline Type Final(const State& s) { return s; }
+
+        static inline Type Compute(const uint8_t* data, size_t len) {
+            State s;
+            Reset(s);
+            Update(s, data, len);
+            return Final(s);
+        }
+
+        static constexpr bool ROLLING = false;
+    }; // struct Crc16Ccitt
+
+
+
+    /// @brief Reflected CRC-32 (IEEE 802.3), slice-by-N for long frames
+    /// @tparam N Bytes consumed per step [1, 4, 8], uses N KB of tables built on first use
+    template <uint8_t N> struct Crc32 {
+        static_assert(N == 1 || N == 4 || N == 8, "slice size must be 1, 4 or 8");
+
+        public:
+        using Type = uint32_t;
+        using State = uint32_t;
+
+        static inline void Reset(State& s) { s = 0xFFFFFFFF; }
+
+        static inline void Update(State& s, uint8_t byte) {
+            s = (s >> 8) ^ Table()[0][(uint8_t)(s ^ byte)];
+        }
+
+        static inline void Update(State& s, const uint8_t* data, size_t len) {
+            const uint32_t (*t)[256] = Table();
+            uint32_t crc = s;
+
+            while (N >= 4 && len >= N) {
+                crc ^= (uint32_t)data[0] | ((uint32_t)data[1] << 8) | ((uint32_t)data[2] << 16) | ((uint32_t)data[3] << 24);
+
+                if (N == 8) {
+                    crc = t[N-1][crc & 0xFF] ^ t[N-2][(crc >> 8) & 0xFF] ^ t[N-3][(crc >> 16) & 0xFF] ^ t[N-4][crc >> 24] ^
+                          t[3][data[4]] ^ t[2][data[5]] ^ t[1][data[6]] ^ t[0][data[7]];
+                } else {
+                    crc = t[3][crc & 0xFF] ^ t[2][(crc >> 8) & 0xFF] ^ t[1][(crc >> 16) & 0xFF] ^ t[0][crc >> 24];
+                }
+
+                data += N;
+                len -= N;
+            }
+
+            while (len--) { crc = (crc >> 8) ^ t[0][(uint8_t)(crc ^ *data++)]; }
+            s = crc;
+        }
+
+        static inline Type Final(const State& s) { return ~s; }
+
+        static inline Type Compute(const uint8_t* data, size_t len) {
+            State s;
+            Reset(s);
+            Update(s, data, len);
+            return Final(s);
+        }
+
+        static constexpr bool ROLLING = false;
+
+        private:
+        struct Tables {
+            uint32_t t[N][256];
+
+            Tables() {
+                for (uint32_t i = 0; i < 256; i++) {
+                    uint32_t c = i;
+                    for (uint8_t k = 0; k < 8; k++) {
+                        c = (c & 1) ? (c >> 1) ^ 0xEDB88320 : (c >> 1);
+                    }
+                    t[0][i] = c;
+                }
+
+                for (uint8_t s = 1; s < N; s++) {
+                    for (uint32_t i = 0; i < 256; i++) {
+                        t[s][i] = (t[s-1][i] >> 8) ^ t[0][t[s-1][i] & 0xFF];
+                    }
+                }
+            }
+        }; // struct Tables
+
+        static inline const uint32_t (*Table())[256] {
+            static const Tables tables;
+            return tables.t;
+        }
+    }; // struct Crc32
+
+
+    /// @brief Calls Drop on rolling policies, policies without one only need ROLLING = false
+    template <typename Policy, bool Rolling = Policy::ROLLING> struct Window {
+        static inline void Drop(typename Policy::State& s, uint8_t byte, size_t len) { (void)s; (void)byte; (void)len; }
+    }; // struct Window
+
+    template <typename Policy> struct Window<Policy, true> {
+        static inline void Drop(typename Policy::State& s, uint8_t byte, size_t len) { Policy::Drop(s, byte, len); }
+    }; // struct Window
+
+} // namespace chk
+} // namespace pckt
@@ -0,0 +1,50 @@
+#pragma once
+#include <stdint.h>
+#include <stddef.h>
+
+namespace pckt {
+namespace cobs {
+
+    /// @brief Byte that ends every COBS frame and never appears inside one
+    static constexpr uint8_t DELIMITER = 0x00;
+
+    /// @brief Longest frame, overhead byte included, that can be stuffed in place with a single overhead byte
+    static constexpr size_t MAX_FRAME = 255;
+
+    /// @brief Stuffs a frame in place, frame[0] is spare and becomes the first code byte
+    ///
+    /// Every zero in frame[1, len) is replaced by the distance to the next zero, or to the end,
+    /// so the frame grows by nothing but the delimiter the caller appends
+    /// @param frame Frame whose first byte may be overwritten
+    /// @param len Number of bytes in the frame, at most MAX_FRAME
+    inline void Encode(uint8_t* frame, size_t len) {
+        size_t code = 0;
+        for (size_t i = 1; i < len; i++) {
+            if (frame[i] == DELIMITER) {
+                frame[code] = (uint8_t)(i - code);
+                code = i;
+            }
+        }
+        frame[code] = (uint8_t)(len - code);
+    }
+
+    /// @brief Restores a frame stuffed by Encode in place, frame[0] is left holding the first code byte
+    /// @param frame Bytes received between two delimiters
+    /// @param len Number of bytes, at most MAX_FRAME
+    /// @return False if the codes don't chain exactly to the end, the frame is corrupt
+    inline bool Decode(uint8_t* frame, size_t len) {
+        if (!len || frame[0] == DELIMITER) return false;
+
+        size_t next = frame[0];
+        while (next < len) {
+            const uint8_t code = frame[next];
+            if (code == DELIMITER) return false;
+            frame[next] = DELIMITER;
+            next += code;
+        }
+
+        return next == len;
+    }
+
+} // namespace cobs
+} // namespace pckt
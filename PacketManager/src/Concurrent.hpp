@@ -0,0 +1,306 @@
+#pragma once
+#include "PacketManager.hpp"
+#include "Queue.hpp"
+
+#if defined(__linux__)
+#include <errno.h>
+#include <poll.h>
+#include <unistd.h>
+#include <sys/eventfd.h>
+#include <atomic>
+#include <memory>
+#include <thread>
+#include <vector>
+
+namespace trns {
+
+    /// @brief A manager any number of threads send through, its link driven by a thread of its own and its handlers
+    /// run on a pool of workers
+    ///
+    /// The manager isn't thread safe, its tx queue, sequence numbers and acks are shared by sending and receiving,
+    /// so only the link thread ever touches it. Send copies the payload into a lock free MpscQueue and returns,
+    /// the link thread moves requests from it into the manager in the order they were claimed, updates it to decode
+    /// and retransmit, and flushes. A request the manager can't take yet stays at the front until it can, once the
+    /// queue is full Send returns WouldBlock. Every frame decoded is copied into the SpscQueue of the worker its
+    /// type was given to, so frames of a type are handled in order and the link thread never waits on a handler
+    /// unless that worker falls a queue behind.
+    ///
+    /// The link thread waits on the transport's fd and an eventfd senders only signal when it sleeps, a transport
+    /// without an fd is polled. Anything else the manager offers, SendMessage, BeginSend or Send\<T\>, is only safe
+    /// while stopped
+    /// @tparam QUEUE Requests the send queue holds and frames each worker's queue holds, a power of two
+    template <typename Config = pckt::DefaultConfig, typename TransportType = pckt::Transport, size_t QUEUE = 1024>
+    struct ConcurrentManager {
+        using Packet = pckt::Packet<Config>;
+        using Manager = pckt::PacketManager<Config, TransportType>;
+        using Delegate = typename Manager::Delegate;
+        using TypeId = typename Config::TypeId;
+
+        public:
+        /// @param fd The fd transport reads, -1 to poll it instead
+        /// @param workers Threads handlers run on, 0 runs them on the link thread
+        /// @param interval Longest time in ms the manager goes without an Update, see EventLoop
+        ConcurrentManager(TransportType& transport, int fd = -1, size_t workers = 1, unsigned long interval = 10)
+            : manager(transport), transport(transport), fd(fd), interval(interval), outbound(new MpscQueue<Request, QUEUE>()),
+              running(false), working(false), sleeping(false), blocked(false) {
+            wake = eventfd(0, EFD_NONBLOCK | EFD_CLOEXEC);
+            for (size_t w = 0; w < workers; w++) pool.emplace_back(new Worker());
+        }
+
+        ~ConcurrentManager() {
+            Stop();
+            if (wake >= 0) ::close(wake);
+        }
+
+        ConcurrentManager(const ConcurrentManager&) = delete;
+        ConcurrentManager& operator=(const ConcurrentManager&) = delete;
+
+
+        /// @brief Sets the handler of type before Start, types are given to the workers in turn
+        /// @return False if the manager refused type, see PacketManager::Callback
+        inline bool Callback(pckt::Type type, Delegate handler) {
+            if (!handler) return manager.Callback(type, handler);
+
+            std::unique_ptr<Route> route(new Route(this, handler, pool.empty() ? nullptr : pool[routes.size() % pool.size()].get()));
+            if (!manager.Callback(type, Delegate::template Method<Route, &Route::Forward>(*route))) return false;
+
+            routes.push_back(std::move(route));
+            return true;
+        }
+
+        /// @brief Queues a packet for the link thread to send, safe to call from any thread
+        /// @param flags Critical bit 0b10000000 and user flags [0-3] of the packet
+        /// @param channel Channel it is queued on, see PacketManager::SetChannel
+        /// @return Queued, or WouldBlock if QUEUE requests are already waiting
+        inline pckt::SendStatus Send(pckt::Type type, const uint8_t* payload, size_t len, uint8_t flags = 0, uint8_t channel = 0) {
+            if (len > Config::MAX_PAYLOAD_SIZE) len = Config::MAX_PAYLOAD_SIZE;
+
+            size_t ticket;
+            Request* request = outbound->Claim(ticket);
+            if (!request) return pckt::SendStatus::WouldBlock;
+
+            request->type = (TypeId)type;
+            request->flags = flags;
+            request->channel = channel;
+            request->len = (uint16_t)len;
+            if (payload) memcpy(request->payload, payload, len);
+            else memset(request->payload, 0, len);
+            outbound->Push(ticket);
+
+            // pairs with the fence in Wait, either the link thread sees the request or this sees it asleep
+            __atomic_thread_fence(__ATOMIC_SEQ_CST);
+            if (__atomic_load_n(&sleeping, __ATOMIC_RELAXED) && __atomic_exchange_n(&sleeping, false, __ATOMIC_RELAXED)) Wake();
+
+            return pckt::SendStatus::Queued;
+        }
+
+        /// @brief Starts the workers and the link thread
+        inline void Start() {
+            if (running) return;
+            running = true;
+            working = true;
+
+            for (auto& w : pool) w->thread = std::thread(&ConcurrentManager::Work, this, std::ref(*w));
+            link = std::thread(&ConcurrentManager::Run, this);
+        }
+
+        /// @brief Stops the link thread, then the workers once they have handled every frame queued for them.
+        /// Requests not sent yet stay queued for the next Start
+        inline void Stop() {
+            if (!running) return;
+            running = false;
+
+            Wake();
+            if (link.joinable()) link.join();
+
+            working = false;
+            for (auto& w : pool) {
+                if (w->thread.joinable()) w->thread.join();
+            }
+        }
+
+        /// @brief The manager, e.g. to read its Stats, only safe to use while stopped
+        inline Manager& LinkManager() { return manager; }
+
+        inline size_t Workers() const { return pool.size(); }
+
+
+        private:
+        struct Worker;
+
+        /// @brief A packet waiting for the link thread
+        struct Request {
+            TypeId type;
+            uint8_t flags;
+            uint8_t channel;
+            uint16_t len;
+            uint8_t payload[Config::MAX_PAYLOAD_SIZE];
+        }; // struct Request
+
+        /// @brief The handler of a type and the worker it runs on, what the manager's handler is bound to
+        struct Route {
+            Route(ConcurrentManager* owner, Delegate handler, Worker* worker) : owner(owner), handler(handler), worker(worker) {}
+
+            /// @brief Copies the frame into the worker's queue, waiting for room unless stopping
+            void Forward(const Packet& packet) {
+                if (!worker) {
+                    handler(packet);
+                    return;
+                }
+
+                Frame* frame;
+                while (!(frame = worker->queue.Claim())) {
+                    if (!owner->running.load(std::memory_order_relaxed)) return;
+                    std::this_thread::yield();
+                }
+
+                frame->route = this;
+                memcpy(frame->packet.self(), packet.self(), packet.FrameSize());
+                worker->queue.Push();
+            }
+
+            ConcurrentManager* owner;
+            Delegate handler;
+            Worker* worker;
+        }; // struct Route
+
+        /// @brief A decoded frame and the route it is handled by, only FrameSize() bytes of packet are copied
+        struct Frame {
+            Route* route;
+            Packet packet;
+        }; // struct Frame
+
+        struct Worker {
+            SpscQueue<Frame, QUEUE> queue;
+            std::thread thread;
+        }; // struct Worker
+
+        Manager manager;
+        TransportType& transport;
+        int fd;
+        int wake;
+        unsigned long interval;
+
+        std::unique_ptr<MpscQueue<Request, QUEUE>> outbound;
+        std::vector<std::unique_ptr<Worker>> pool;
+        std::vector<std::unique_ptr<Route>> routes;
+        std::thread link;
+
+        std::atomic<bool> running;
+        std::atomic<bool> working;
+        bool sleeping; // the link thread is about to wait or waiting, senders have to wake it
+        bool blocked; // the manager refused the request at the front of the queue
+
+        inline void Wake() {
+            const uint64_t one = 1;
+            if (wake >= 0 && ::write(wake, &one, sizeof(one)) < 0) {}
+        }
+
+        /// @brief Moves queued requests into the manager until it refuses one, at most a queue's worth
+        /// @return Number of requests the manager took
+        inline size_t Drain() {
+            size_t n = 0;
+            Request* request;
+            blocked = false;
+            while (n < QUEUE && (request = outbound->Front())) {
+                manager.SetChannel(request->channel);
+                manager.SetCritical(request->flags & 0b10000000);
+                manager.template SetFlag<0>(request->flags & 0b0001);
+                manager.template SetFlag<1>(request->flags & 0b0010);
+                manager.template SetFlag<2>(request->flags & 0b0100);
+                manager.template SetFlag<3>(request->flags & 0b1000);
+
+                if (manager.Send((pckt::Type)request->type, request->payload, request->len) == pckt::SendStatus::WouldBlock) {
+                    blocked = true;
+                    break;
+                }
+
+                outbound->Pop();
+                n++;
+            }
+
+            return n;
+        }
+
+        /// @brief Waits for the fd, a send or the interval, a polled transport only once it has gone quiet
+        inline void Wait(bool busy, size_t& idle) {
+            if (busy) {
+                idle = 0;
+                return;
+            }
+
+            if (fd < 0 && ++idle <= 64) return;
+
+            __atomic_store_n(&sleeping, true, __ATOMIC_RELAXED);
+            __atomic_thread_fence(__ATOMIC_SEQ_CST);
+
+            // a request the manager refused waits for the fd to drain or an ack, not for another send
+            if ((!blocked && outbound->Front()) || !running.load(std::memory_order_relaxed)) {
+                __atomic_store_n(&sleeping, false, __ATOMIC_RELAXED);
+                return;
+            }
+
+            pollfd fds[2];
+            fds[0].fd = wake;
+            fds[0].events = POLLIN;
+            fds[1].fd = fd;
+            fds[1].events = POLLIN | (manager.Pending() ? POLLOUT : 0);
+
+            // a polled transport is checked again after 50 us, as a Gateway does
+            const timespec timeout = fd < 0 ? timespec{ 0, 50000 } : timespec{ (time_t)(interval / 1000), (long)(interval % 1000) * 1000000 };
+            ppoll(fds, fd < 0 ? 1 : 2, &timeout, nullptr);
+
+            __atomic_store_n(&sleeping, false, __ATOMIC_RELAXED);
+
+            uint64_t count;
+            if (fds[0].revents & POLLIN && ::read(wake, &count, sizeof(count)) < 0) {}
+        }
+
+        inline void Run() {
+            size_t idle = 0;
+
+            while (running.load(std::memory_order_relaxed)) {
+                bool busy = fd < 0 && transport.available();
+
+                // requests go in after the acks this update reads, then once more if the flush made room for them
+                manager.Update();
+                size_t sent = Drain();
+                manager.Flush();
+
+                if (blocked) {
+                    sent += Drain();
+                    manager.Flush();
+                }
+
+                Wait(busy || sent > 0, idle);
+            }
+
+            manager.Flush();
+        }
+
+        inline void Work(Worker& worker) {
+            size_t idle = 0;
+
+            for (;;) {
+                Frame* frame = worker.queue.Front();
+                if (!frame) {
+                    // stopping only once the link thread is done and everything it queued is handled, what it
+                    // queued after the look above shows up in the one after seeing it done
+                    if (!working.load(std::memory_order_acquire)) {
+                        if (!worker.queue.Front()) return;
+                        continue;
+                    }
+
+                    if (++idle > 64) std::this_thread::sleep_for(std::chrono::microseconds(50));
+                    continue;
+                }
+
+                idle = 0;
+                frame->route->handler(frame->packet);
+                worker.queue.Pop();
+            }
+        }
+    }; // struct ConcurrentManager
+
+} // namespace trns
+#endif
@@ -0,0 +1,182 @@
+#pragma once
+#include "Platform.hpp"
+#include "Packet.hpp"
+
+namespace pckt {
+
+    /// @brief Sends payloads of the types Config::DeltaCoded picks as the bytes that changed since the last keyframe
+    /// of their type, compiled away when DELTA_KEYFRAME is 0
+    ///
+    /// A coded frame has the delta flag set and its payload starts with a header byte, the top bit set and the
+    /// key id below it for a keyframe, which is followed by the whole payload, or just the id of the keyframe a
+    /// delta is against, which is followed by a bitmask of the bytes that differ from it, bit i of byte i/8,
+    /// and those bytes in order. Every delta is against the last keyframe so losing one costs only itself,
+    /// losing a keyframe costs the deltas until the next one
+    template <typename Config, bool Enabled = (Config::DELTA_KEYFRAME > 0)>
+    struct Delta {
+        using Packet = pckt::Packet<Config>;
+        using TypeId = typename Config::TypeId;
+
+        static constexpr uint8_t DELTA_FLAG = 0b00100000;
+
+        public:
+        /// @brief Checks a payload of type is sent coded
+        inline bool Codes(TypeId type, const uint8_t* payload, size_t len) const {
+            (void)type; (void)payload; (void)len;
+            return false;
+        }
+
+        /// @brief Decides between a keyframe and a delta for the next payload of type
+        /// @return Payload bytes the coded frame takes
+        inline size_t Plan(TypeId type, const uint8_t* payload, size_t len) {
+            (void)type; (void)payload;
+            return len;
+        }
+
+        /// @brief Codes the payload as planned into a frame's payload, the planned keyframe becomes the reference
+        inline void Encode(TypeId type, const uint8_t* payload, size_t len, uint8_t* out) {
+            (void)type; (void)payload; (void)len; (void)out;
+        }
+
+        /// @brief Rebuilds the full payload of a coded packet
+        /// @return The packet the handler gets, nullptr if it is a delta against a keyframe that never arrived
+        inline const Packet* Decode(const Packet& packet) { return &packet; }
+    }; // struct Delta
+
+
+    template <typename Config> struct Delta<Config, true> {
+        using Packet = pckt::Packet<Config>;
+        using TypeId = typename Config::TypeId;
+
+        static constexpr uint8_t DELTA_FLAG = 0b00100000;
+        static constexpr uint8_t KEY_BIT = 0x80;
+
+        /// @brief Longest payload that can be coded, a keyframe takes one byte more
+        static constexpr size_t MAX_CODED = Config::MAX_PAYLOAD_SIZE - 1;
+
+        static_assert(Config::VARIABLE_LENGTH, "delta coding only saves bytes with variable length frames");
+        static_assert(Config::MAX_PAYLOAD_SIZE >= 2, "coded frames need 2 payload bytes");
+        static_assert(Config::DELTA_KEYFRAME <= 0xFFFF, "keyframe interval must fit 16 bits");
+
+        public:
+        Delta() {
+            for (size_t t = 0; t < Config::PACKET_COUNT; t++) {
+                tx[t].valid = false;
+                tx[t].id = 0;
+                rx[t].valid = false;
+            }
+
+            planKey = false;
+        }
+
+        inline bool Codes(TypeId type, const uint8_t* payload, size_t len) const {
+            return type < Config::PACKET_COUNT && Config::DeltaCoded(type) && payload && len <= MAX_CODED;
+        }
+
+        inline size_t Plan(TypeId type, const uint8_t* payload, size_t len) {
+            const Reference& ref = tx[type];
+            const size_t key = 1 + len;
+
+            planKey = !ref.valid || ref.len != len || (size_t)ref.sinceKey + 1 >= Config::DELTA_KEYFRAME;
+            if (planKey) return key;
+
+            size_t changed = 0;
+            for (size_t i = 0; i < len; i++) {
+                changed += payload[i] != ref.payload[i];
+            }
+
+            // a keyframe is no larger, it also brings the reference closer
+            const size_t delta = 1 + MaskBytes(len) + changed;
+            planKey = delta >= key;
+            return planKey ? key : delta;
+        }
+
+        inline void Encode(TypeId type, const uint8_t* payload, size_t len, uint8_t* out) {
+            Reference& ref = tx[type];
+
+            if (planKey) {
+                ref.id = (ref.id + 1) & ~KEY_BIT;
+                ref.len = (uint8_t)len;
+                ref.sinceKey = 0;
+                ref.valid = true;
+                memcpy(ref.payload, payload, len);
+
+                out[0] = KEY_BIT | ref.id;
+                memcpy(out + 1, payload, len);
+                return;
+            }
+
+            ref.sinceKey++;
+            out[0] = ref.id;
+
+            uint8_t* mask = out + 1;
+            uint8_t* changed = mask + MaskBytes(len);
+            memset(mask, 0, MaskBytes(len));
+
+            for (size_t i = 0; i < len; i++) {
+                if (payload[i] == ref.payload[i]) continue;
+                mask[i >> 3] |= (uint8_t)(1u << (i & 7));
+                *changed++ = payload[i];
+            }
+        }
+
+        inline const Packet* Decode(const Packet& packet) {
+            if (!(packet.flags & DELTA_FLAG)) return &packet;
+
+            const size_t len = packet.PayloadLength();
+            if (!len || packet.type >= Config::PACKET_COUNT) return nullptr;
+
+            Reference& ref = rx[packet.type];
+            const uint8_t header = packet.payload[0];
+
+            if (header & KEY_BIT) {
+                ref.id = header & ~KEY_BIT;
+                ref.len = (uint8_t)(len - 1);
+                ref.valid = true;
+                memcpy(ref.payload, packet.payload + 1, ref.len);
+            } else if (!ref.valid || ref.id != header) {
+                return nullptr;
+            }
+
+            memcpy(decoded.self(), packet.self(), Packet::HEADER_SIZE);
+            decoded.flags &= ~DELTA_FLAG;
+            decoded.SetPayloadLength(ref.len);
+            memcpy(decoded.payload, ref.payload, ref.len);
+            if (header & KEY_BIT) return &decoded;
+
+            // the bitmask says how many bytes follow it, anything else isn't a delta against this keyframe
+            const size_t maskBytes = MaskBytes(ref.len);
+            if (len < 1 + maskBytes) return nullptr;
+
+            const uint8_t* mask = packet.payload + 1;
+            const uint8_t* changed = mask + maskBytes;
+            const uint8_t* end = packet.payload + len;
+
+            for (size_t i = 0; i < ref.len; i++) {
+                if (!(mask[i >> 3] & (1u << (i & 7)))) continue;
+                if (changed == end) return nullptr;
+                decoded.payload[i] = *changed++;
+            }
+
+            return changed == end ? &decoded : nullptr;
+        }
+
+
+        private:
+        struct Reference {
+            uint8_t payload[MAX_CODED];
+            uint8_t len;
+            uint8_t id;
+            bool valid;
+            uint16_t sinceKey; // deltas sent since the keyframe, sender only
+        }; // struct Reference
+
+        Reference tx[Config::PACKET_COUNT];
+        Reference rx[Config::PACKET_COUNT];
+        Packet decoded;
+        bool planKey;
+
+        static inline size_t MaskBytes(size_t len) { return (len + 7) / 8; }
+    }; // struct Delta
+
+} // namespace pckt
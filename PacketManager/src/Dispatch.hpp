@@ -0,0 +1,233 @@
+#pragma once
+#include "Platform.hpp"
+#include "Packet.hpp"
+
+namespace pckt {
+
+    /// @brief A packet handler and the object it is bound to, two pointers and no heap
+    ///
+    /// Made from a plain function, or with Method and Bind from a member function or a function taking a
+    /// context, those two are template arguments so the call through the delegate reaches them directly
+    ///
+    /// manager.Callback(pckt::Type::DataPacket, Manager::Delegate::Method<Radio, &Radio::OnData>(radio));
+    template <typename Packet> struct Delegate {
+        using Function = void(*)(const Packet&);
+
+        public:
+        Delegate() : thunk(nullptr) { target.object = nullptr; }
+        Delegate(Function function) : thunk(function ? &CallFunction : nullptr) { target.function = function; }
+
+        /// @brief Calls (object.*method)(packet), object must outlive the delegate
+        template <typename C, void (C::*method)(const Packet&)> static inline Delegate Method(C& object) {
+            Delegate delegate;
+            delegate.thunk = &CallMethod<C, method>;
+            delegate.target.object = &object;
+            return delegate;
+        }
+
+        /// @brief Calls function(context, packet), context must outlive the delegate
+        template <typename C, void (*function)(C&, const Packet&)> static inline Delegate Bind(C& context) {
+            Delegate delegate;
+            delegate.thunk = &CallBound<C, function>;
+            delegate.target.object = &context;
+            return delegate;
+        }
+
+        inline void operator()(const Packet& packet) const { thunk(target, packet); }
+
+        /// @brief A handler is set
+        explicit inline operator bool() const { return thunk != nullptr; }
+
+
+        private:
+        union Target {
+            void* object;
+            Function function;
+        }; // union Target
+
+        void (*thunk)(const Target&, const Packet&);
+        Target target;
+
+        static void CallFunction(const Target& target, const Packet& packet) { target.function(packet); }
+
+        template <typename C, void (C::*method)(const Packet&)> static void CallMethod(const Target& target, const Packet& packet) {
+            (static_cast<C*>(target.object)->*method)(packet);
+        }
+
+        template <typename C, void (*function)(C&, const Packet&)> static void CallBound(const Target& target, const Packet& packet) {
+            function(*static_cast<C*>(target.object), packet);
+        }
+    }; // struct Delegate
+
+
+    /// @brief Handlers of types at or above PACKET_COUNT, anywhere in the range of Config::TypeId, compiled away
+    /// when SPARSE_HANDLERS is 0
+    ///
+    /// A two level perfect hash: a type's first hash picks a bucket, the bucket's seed feeds its second hash
+    /// which picks a slot no other registered type uses. Seeds are searched for as handlers are registered,
+    /// so a lookup is two hashes, three loads and one compare whatever the type. Two slots and half a bucket per
+    /// handler, each a byte, on top of the handlers themselves
+    template <typename Config, bool Enabled = (Config::SPARSE_HANDLERS > 0)>
+    struct SparseHandlers {
+        using TypeId = typename Config::TypeId;
+        using Handler = Delegate<Packet<Config>>;
+
+        public:
+        /// @brief Sets, replaces or with an empty handler removes the handler of type
+        /// @return False if the table is full or no seeds could be found with type in it
+        inline bool Set(TypeId type, Handler handler) { (void)type; (void)handler; return false; }
+
+        /// @brief The handler of type, nullptr if none is set
+        inline const Handler* Find(TypeId type) const { (void)type; return nullptr; }
+    }; // struct SparseHandlers
+
+
+    template <typename Config> struct SparseHandlers<Config, true> {
+        using TypeId = typename Config::TypeId;
+        using Handler = Delegate<Packet<Config>>;
+
+        static constexpr size_t SLOTS = 2 * Config::SPARSE_HANDLERS;
+        static constexpr size_t BUCKETS = (Config::SPARSE_HANDLERS + 1) / 2;
+
+        static_assert(Config::SPARSE_HANDLERS < 255, "slots index handlers with a byte");
+        static_assert(sizeof(TypeId) <= 2, "types are hashed as 16 bits");
+
+        public:
+        SparseHandlers() : count(0) {
+            memset(slots, 0, sizeof(slots));
+            memset(seeds, 1, sizeof(seeds));
+        }
+
+        inline bool Set(TypeId type, Handler handler) {
+            for (size_t e = 0; e < count; e++) {
+                if (entries[e].type != type) continue;
+
+                if (handler) entries[e].handler = handler;
+                else Remove(e);
+                return true;
+            }
+
+            if (!handler) return true;
+            if (count == Config::SPARSE_HANDLERS) return false;
+
+            // placing the types again without type can fail where the order they were added in didn't, so a
+            // type that doesn't fit puts back the slots and seeds the others were found with
+            uint8_t placed[SLOTS];
+            uint8_t seeded[BUCKETS];
+            memcpy(placed, slots, sizeof(slots));
+            memcpy(seeded, seeds, sizeof(seeds));
+
+            entries[count].type = type;
+            entries[count].handler = handler;
+            count++;
+
+            // usually only type's bucket has to move, otherwise every bucket is placed again
+            const size_t bucket = Bucket(type);
+            Clear(bucket, seeds[bucket], count - 1);
+            if (Place(bucket) || Rebuild()) return true;
+
+            count--;
+            memcpy(slots, placed, sizeof(slots));
+            memcpy(seeds, seeded, sizeof(seeds));
+            return false;
+        }
+
+        inline const Handler* Find(TypeId type) const {
+            const uint8_t e = slots[Slot(type, seeds[Bucket(type)])];
+            return e && entries[e-1].type == type ? &entries[e-1].handler : nullptr;
+        }
+
+
+        private:
+        struct Entry {
+            TypeId type;
+            Handler handler;
+        }; // struct Entry
+
+        Entry entries[Config::SPARSE_HANDLERS];
+        uint8_t slots[SLOTS];     // entry + 1 of the type hashed there, 0 for none
+        uint8_t seeds[BUCKETS];   // second hash seed of the types in each bucket, 1 to 255
+        size_t count;
+
+        /// @brief 16 bit xorshift multiply mix of the seeded key, cheap on an 8 bit mcu with a hardware multiplier
+        static inline uint16_t Hash(uint16_t key, uint8_t seed) {
+            uint16_t h = (uint16_t)(key + seed * 0x9E37u);
+            h ^= h >> 8;
+            h = (uint16_t)(h * 0x88B5u);
+            h ^= h >> 7;
+            h = (uint16_t)(h * 0xDB2Du);
+            return h ^ (h >> 9);
+        }
+
+        // the top bits of the hash scaled to the range, no division
+        static inline size_t Bucket(TypeId type) { return (size_t)(((uint32_t)Hash(type, 0) * BUCKETS) >> 16); }
+        static inline size_t Slot(TypeId type, uint8_t seed) { return (size_t)(((uint32_t)Hash(type, seed) * SLOTS) >> 16); }
+
+        /// @brief Frees the slots of the first n entries in bucket
+        inline void Clear(size_t bucket, uint8_t seed, size_t n) {
+            for (size_t e = 0; e < n; e++) {
+                if (Bucket(entries[e].type) == bucket) slots[Slot(entries[e].type, seed)] = 0;
+            }
+        }
+
+        /// @brief Finds a seed that puts every entry of an unplaced bucket in a free slot of its own
+        inline bool Place(size_t bucket) {
+            for (uint16_t seed = 1; seed < 256; seed++) {
+                size_t e = 0;
+                for (; e < count; e++) {
+                    if (Bucket(entries[e].type) != bucket) continue;
+
+                    uint8_t& slot = slots[Slot(entries[e].type, (uint8_t)seed)];
+                    if (slot) break;
+                    slot = (uint8_t)(e + 1);
+                }
+
+                if (e == count) {
+                    seeds[bucket] = (uint8_t)seed;
+                    return true;
+                }
+
+                Clear(bucket, (uint8_t)seed, e);
+            }
+
+            return false;
+        }
+
+        /// @brief Places every bucket again, the fullest first while most slots are still free
+        inline bool Rebuild() {
+            memset(slots, 0, sizeof(slots));
+
+            size_t fullest = 0;
+            for (size_t bucket = 0; bucket < BUCKETS; bucket++) {
+                const size_t n = Size(bucket);
+                if (n > fullest) fullest = n;
+            }
+
+            for (size_t size = fullest; size; size--) {
+                for (size_t bucket = 0; bucket < BUCKETS; bucket++) {
+                    if (Size(bucket) == size && !Place(bucket)) return false;
+                }
+            }
+
+            return true;
+        }
+
+        inline size_t Size(size_t bucket) const {
+            size_t n = 0;
+            for (size_t e = 0; e < count; e++) n += Bucket(entries[e].type) == bucket;
+            return n;
+        }
+
+        /// @brief Drops entry e, the last entry takes its place and its slot is pointed there, no seed changes
+        inline void Remove(size_t e) {
+            slots[Slot(entries[e].type, seeds[Bucket(entries[e].type)])] = 0;
+
+            count--;
+            if (e == count) return;
+
+            entries[e] = entries[count];
+            slots[Slot(entries[e].type, seeds[Bucket(entries[e].type)])] = (uint8_t)(e + 1);
+        }
+    }; // struct SparseHandlers
+
+} // namespace pckt
@@ -0,0 +1,251 @@
+#pragma once
+#include "Platform.hpp"
+#include "Transport.hpp"
+
+namespace trns {
+
+    /// @brief Impairments of an emulated link, all off by default
+    ///
+    /// Probabilities are per byte except the bit error rates, which are per bit. Bit errors are Bernoulli at
+    /// bitErrorRate unless enterBurst is set, then the link is a Gilbert-Elliott channel: each byte it moves
+    /// from the good state to the bad one with probability enterBurst and back with leaveBurst, and bits err at
+    /// bitErrorRate in the good state and burstErrorRate in the bad one
+    struct LinkModel {
+        uint32_t seed = 1;
+
+        unsigned long bytesPerSecond = 0; // 0 for no limit, see Uart
+        size_t fifo = 16;                 // bytes a write can take at once before the rate catches up, at least 1
+        unsigned long latency = 0;        // microseconds from write to read
+        unsigned long jitter = 0;         // up to this many more microseconds a chunk, bytes never overtake each other
+
+        double bitErrorRate = 0;
+        double burstErrorRate = 0;
+        double enterBurst = 0;
+        double leaveBurst = 0;
+
+        double dropRate = 0;
+        double duplicateRate = 0;
+
+        double shortReadRate = 0;  // reads handing back fewer bytes than were ready and asked for
+        double shortWriteRate = 0; // writes taking fewer bytes than the rate allows
+
+        /// @brief A serial port at baud, 8N1 so 10 bits on the wire a byte
+        static inline LinkModel Uart(unsigned long baud) {
+            LinkModel model;
+            model.bytesPerSecond = baud / 10;
+            return model;
+        }
+    }; // struct LinkModel
+
+
+    /// @brief What a LinkEmulator has done to the bytes through it
+    struct LinkDamage {
+        uint32_t bitsFlipped;
+        uint32_t bytesDropped;
+        uint32_t bytesDuplicated;
+        uint32_t shortReads;
+        uint32_t shortWrites;
+    }; // struct LinkDamage
+
+
+    /// @brief Transport decorator that puts an emulated link between a manager and another transport
+    ///
+    /// Writes reach inner as the link's rate lets them, a write taking only what its fifo has room for, so the
+    /// sending manager's tx queue backs up as it would on a slow port. Bytes read from inner are dropped,
+    /// corrupted and duplicated as they are pulled into a delay line and only read once their latency has passed,
+    /// one manager writing and another reading through the same emulator over a loopback transport sees the whole
+    /// link. Every byte draws from a seeded generator of its own in order, so a seed always damages the same
+    /// stream the same way however the reads and writes are timed
+    /// @tparam Inner Transport the link runs over, Transport dispatches through the vtable, a final one inlines
+    /// @tparam N Bytes the delay line holds, at least bytesPerSecond * (latency + jitter) / 1000000 for the rate
+    template <typename Inner = pckt::Transport, size_t N = 4096> struct LinkEmulator final : public pckt::Transport {
+        static_assert(N >= 2 && (N & (N-1)) == 0, "delay line size must be a power of two");
+
+        public:
+        LinkEmulator(Inner& inner, const LinkModel& model) : inner(inner), model(model) {
+            if (!this->model.fifo) this->model.fifo = 1;
+            bitError = Threshold(model.bitErrorRate);
+            burstError = Threshold(model.burstErrorRate);
+            enterBurst = Threshold(model.enterBurst);
+            leaveBurst = Threshold(model.leaveBurst);
+            drop = Threshold(model.dropRate);
+            duplicate = Threshold(model.duplicateRate);
+            shortRead = Threshold(model.shortReadRate);
+            shortWrite = Threshold(model.shortWriteRate);
+            Reset();
+        }
+
+        LinkEmulator(const LinkEmulator&) = delete;
+        LinkEmulator& operator=(const LinkEmulator&) = delete;
+
+
+        int read(uint8_t* data, size_t len) override {
+            Pull();
+
+            const unsigned long now = pckt::Micros();
+            size_t n = 0;
+            while (n < len && n < count && Due(head + n, now)) n++;
+
+            if (n > 1 && Chance(timing, shortRead)) {
+                n = 1 + Next(timing) % (n - 1);
+                damage.shortReads++;
+            }
+
+            for (size_t i = 0; i < n; i++) data[i] = bytes[(head + i) & MASK];
+            head = (head + n) & MASK;
+            count -= n;
+            return (int)n;
+        }
+
+        size_t write(const uint8_t* data, size_t len) override {
+            size_t n = len;
+            if (model.bytesPerSecond) {
+                Refill();
+                if (n > tokens) n = tokens;
+            }
+
+            if (n && Chance(timing, shortWrite)) {
+                n = Next(timing) % n;
+                damage.shortWrites++;
+            }
+
+            n = inner.write(data, n);
+            if (model.bytesPerSecond) tokens -= n;
+            return n;
+        }
+
+        bool available() override {
+            Pull();
+            return count && Due(head, pckt::Micros());
+        }
+
+
+        /// @brief Empties the delay line and starts the seeded streams, the rate and the damage counters over
+        inline void Reset() {
+            head = 0;
+            count = 0;
+            lastDue = pckt::Micros();
+            bytesState = model.seed ? model.seed : 1;
+            timing = bytesState ^ 0x9E3779B9u;
+            if (!timing) timing = 1;
+            burst = false;
+            tokens = model.fifo;
+            carry = 0;
+            refilledAt = pckt::Micros();
+            memset(&damage, 0, sizeof(damage));
+        }
+
+        /// @brief Bytes pulled from inner that haven't been read yet
+        inline size_t Queued() const { return count; }
+
+        inline const LinkDamage& Damage() const { return damage; }
+
+
+        private:
+        static constexpr size_t MASK = N - 1;
+
+        Inner& inner;
+        LinkModel model;
+
+        // probabilities scaled to the generators' 32 bit range
+        uint32_t bitError, burstError, enterBurst, leaveBurst;
+        uint32_t drop, duplicate, shortRead, shortWrite;
+
+        uint8_t bytes[N];
+        unsigned long due[N]; // when each byte may be read
+        size_t head;
+        size_t count;
+        unsigned long lastDue;
+
+        uint32_t bytesState; // draws for every byte through the link
+        uint32_t timing;     // draws for jitter, short reads and writes, which depend on how the link is driven
+        bool burst;          // in the bad state of the Gilbert-Elliott channel
+
+        size_t tokens;
+        uint64_t carry; // byte-microseconds short of the next whole token
+        unsigned long refilledAt;
+
+        LinkDamage damage;
+
+        static inline uint32_t Threshold(double p) {
+            if (p <= 0) return 0;
+            if (p >= 1) return 0xFFFFFFFFu;
+            return (uint32_t)(p * 4294967296.0);
+        }
+
+        /// @brief xorshift32, fast and plenty for picking which bytes get damaged
+        static inline uint32_t Next(uint32_t& state) {
+            state ^= state << 13;
+            state ^= state >> 17;
+            state ^= state << 5;
+            return state;
+        }
+
+        static inline bool Chance(uint32_t& state, uint32_t threshold) {
+            return threshold && (threshold == 0xFFFFFFFFu || Next(state) < threshold);
+        }
+
+        inline bool Due(size_t at, unsigned long now) const { return (long)(now - due[at & MASK]) >= 0; }
+
+        /// @brief Tokens accrue at bytesPerSecond up to the fifo, the fraction carries over
+        inline void Refill() {
+            const unsigned long now = pckt::Micros();
+            const unsigned long elapsed = now - refilledAt;
+            refilledAt = now;
+
+            carry += (uint64_t)elapsed * model.bytesPerSecond;
+            const uint64_t whole = carry / 1000000u;
+            carry %= 1000000u;
+
+            tokens = whole >= model.fifo - tokens ? model.fifo : tokens + (size_t)whole;
+            if (tokens == model.fifo) carry = 0;
+        }
+
+        /// @brief Moves what inner has into the delay line as it fits, each byte through the link model
+        inline void Pull() {
+            uint8_t chunk[64];
+            while (N - count >= 2 * sizeof(chunk) && inner.available()) {
+                const int n = inner.read(chunk, sizeof(chunk));
+                if (n <= 0) break;
+
+                // a chunk arrives in one piece, late by the same jitter
+                const unsigned long at = pckt::Micros() + model.latency + (model.jitter ? Next(timing) % (model.jitter + 1) : 0);
+                for (int i = 0; i < n; i++) Carry(chunk[i], at);
+            }
+        }
+
+        /// @brief Drops, corrupts and duplicates a byte and stamps when it may be read, no sooner than the one before
+        inline void Carry(uint8_t byte, unsigned long at) {
+            if (Chance(bytesState, drop)) {
+                damage.bytesDropped++;
+                return;
+            }
+
+            if (burst ? Chance(bytesState, leaveBurst) : Chance(bytesState, enterBurst)) burst = !burst;
+
+            const uint32_t error = burst ? burstError : bitError;
+            for (uint8_t bit = 0; error && bit < 8; bit++) {
+                if (!Chance(bytesState, error)) continue;
+                byte ^= (uint8_t)(1u << bit);
+                damage.bitsFlipped++;
+            }
+
+            if ((long)(at - lastDue) < 0) at = lastDue;
+            lastDue = at;
+
+            Queue(byte, at);
+            if (Chance(bytesState, duplicate)) {
+                Queue(byte, at);
+                damage.bytesDuplicated++;
+            }
+        }
+
+        inline void Queue(uint8_t byte, unsigned long at) {
+            const size_t tail = (head + count) & MASK;
+            bytes[tail] = byte;
+            due[tail] = at;
+            count++;
+        }
+    }; // struct LinkEmulator
+
+} // namespace trns
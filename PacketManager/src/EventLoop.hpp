@@ -0,0 +1,160 @@
+#pragma once
+#include "Platform.hpp"
+#include "Packet.hpp"
+
+#if defined(__linux__)
+#include <errno.h>
+#include <unistd.h>
+#include <sys/epoll.h>
+
+namespace trns {
+
+    /// @brief Waits on the fds of up to N managers with epoll and only updates a manager when its fd is readable,
+    /// or writable while it has frames the transport didn't take, instead of polling available() in a loop
+    ///
+    /// Every update is followed by a Flush so whatever the handlers sent during it goes out in one write. Managers
+    /// are still updated at least every interval ms so retransmits and read timeouts run on quiet links. A manager
+    /// whose fd hangs up is updated once more for whatever it had buffered and is then dropped from the loop
+    /// @tparam N Most managers the loop drives
+    template <size_t N = 8> struct EventLoop {
+        public:
+        /// @param interval Longest time in ms a manager goes without an Update
+        EventLoop(unsigned long interval = 10) : interval(interval), count(0) {
+            epfd = epoll_create1(EPOLL_CLOEXEC);
+        }
+
+        ~EventLoop() {
+            if (epfd >= 0) ::close(epfd);
+        }
+
+        EventLoop(const EventLoop&) = delete;
+        EventLoop& operator=(const EventLoop&) = delete;
+
+
+        /// @brief Starts driving manager whenever fd, the fd its transport reads, is ready
+        /// @return False if the loop is full, fd is already in it or epoll refused it
+        template <typename Manager> inline bool Add(int fd, Manager& manager) {
+            if (epfd < 0 || count >= N || Find(fd) < N) return false;
+
+            Entry& entry = entries[count];
+            entry.fd = fd;
+            entry.manager = &manager;
+            entry.update = &Thunk<Manager>::Update;
+            entry.flush = &Thunk<Manager>::Flush;
+            entry.writable = false;
+            entry.updatedAt = pckt::Millis();
+
+            epoll_event ev;
+            ev.events = (uint32_t)EPOLLIN | (uint32_t)EPOLLRDHUP;
+            ev.data.u64 = Key(fd, count);
+            if (epoll_ctl(epfd, EPOLL_CTL_ADD, fd, &ev) != 0) return false;
+
+            count++;
+            return true;
+        }
+
+        /// @brief Stops driving the manager of fd
+        /// @return False if fd isn't in the loop
+        inline bool Remove(int fd) {
+            const size_t i = Find(fd);
+            if (i >= N) return false;
+
+            epoll_ctl(epfd, EPOLL_CTL_DEL, fd, nullptr);
+            entries[i] = entries[--count];
+            if (i < count) Watch(entries[i], i, entries[i].writable);
+            return true;
+        }
+
+        /// @brief Waits up to timeout ms for any fd to become ready and updates the managers that are, along with any
+        /// that went interval ms without an update
+        /// @param timeout -1 waits for an fd or the interval, whichever comes first
+        /// @return Number of managers updated because their fd was ready, -1 if epoll failed
+        inline int Poll(int timeout = -1) {
+            if (timeout < 0 || (unsigned long)timeout > interval) timeout = (int)interval;
+
+            epoll_event ready[N];
+            int n = epoll_wait(epfd, ready, (int)N, timeout);
+            if (n < 0) {
+                if (errno != EINTR) return -1;
+                n = 0;
+            }
+
+            const unsigned long now = pckt::Millis();
+
+            for (int r = 0; r < n; r++) {
+                const int fd = (int)(ready[r].data.u64 >> 32);
+                size_t i = (size_t)(uint32_t)ready[r].data.u64;
+
+                // a hang up earlier in this batch may have moved the entry
+                if (i >= count || entries[i].fd != fd) i = Find(fd);
+                if (i >= N) continue;
+
+                Update(entries[i], i, now);
+
+                if (ready[r].events & (EPOLLHUP | EPOLLRDHUP | EPOLLERR)) Remove(fd);
+            }
+
+            for (size_t i = 0; i < count; i++) {
+                if (now - entries[i].updatedAt >= interval) Update(entries[i], i, now);
+            }
+
+            return n;
+        }
+
+        /// @brief Number of managers in the loop
+        inline size_t Size() const { return count; }
+
+
+        private:
+        struct Entry {
+            int fd;
+            void* manager;
+            void (*update)(void*);
+            bool (*flush)(void*);
+            bool writable; // waiting on EPOLLOUT
+            unsigned long updatedAt;
+        }; // struct Entry
+
+        template <typename Manager> struct Thunk {
+            static void Update(void* manager) { static_cast<Manager*>(manager)->Update(); }
+            static bool Flush(void* manager) { return static_cast<Manager*>(manager)->Flush() != pckt::SendStatus::Sent; }
+        }; // struct Thunk
+
+        int epfd;
+        unsigned long interval;
+        Entry entries[N];
+        size_t count;
+
+
+        /// @brief What epoll hands back for an fd, the fd and where its entry is so a ready fd is found without a search
+        static inline uint64_t Key(int fd, size_t i) { return ((uint64_t)(uint32_t)fd << 32) | (uint32_t)i; }
+
+        inline size_t Find(int fd) const {
+            for (size_t i = 0; i < count; i++) {
+                if (entries[i].fd == fd) return i;
+            }
+
+            return N;
+        }
+
+        /// @brief Updates and flushes a manager, then waits on its fd becoming writable only while it has bytes the
+        /// transport didn't take
+        inline void Update(Entry& entry, size_t i, unsigned long now) {
+            entry.update(entry.manager);
+            entry.updatedAt = now;
+
+            const bool writable = entry.flush(entry.manager);
+            if (writable != entry.writable) Watch(entry, i, writable);
+        }
+
+        inline void Watch(Entry& entry, size_t i, bool writable) {
+            epoll_event ev;
+            ev.events = (uint32_t)EPOLLIN | (uint32_t)EPOLLRDHUP | (writable ? (uint32_t)EPOLLOUT : 0u);
+            ev.data.u64 = Key(entry.fd, i);
+            epoll_ctl(epfd, EPOLL_CTL_MOD, entry.fd, &ev);
+            entry.writable = writable;
+        }
+    }; // struct EventLoop
+
+} // namespace trns
+#endif
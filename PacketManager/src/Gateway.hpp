@@ -0,0 +1,206 @@
+#pragma once
+#include "PacketManager.hpp"
+#include "EventLoop.hpp"
+#include "Queue.hpp"
+
+#if defined(__linux__)
+#include <pthread.h>
+#include <sched.h>
+#include <atomic>
+#include <memory>
+#include <thread>
+#include <vector>
+
+namespace trns {
+
+    /// @brief Decodes thousands of links on a fixed set of worker threads and hands every frame to consumer threads
+    ///
+    /// Links are spread over the workers when added, each worker owns the managers of its links and is the only
+    /// thread that touches them. Frames go into the worker's SpscQueue tagged with their link, consumer c of
+    /// C drains the queues of workers c, c+C, c+2C... so workers never share a cache line or a lock and
+    /// throughput grows with the cores given to them. A full queue holds its worker back until it is drained,
+    /// the links' transports buffer in the meantime.
+    ///
+    /// Links with an fd are waited on with an EventLoop, others are polled. Sending on a link isn't thread safe,
+    /// only handlers run on its worker
+    /// @tparam SHARD_LINKS Most links with an fd a worker waits on
+    /// @tparam QUEUE Frames each worker's queue holds, a power of two
+    template <typename Config = pckt::DefaultConfig, typename TransportType = pckt::Transport, size_t SHARD_LINKS = 1024, size_t QUEUE = 4096>
+    struct Gateway {
+        using Packet = pckt::Packet<Config>;
+        using Manager = pckt::PacketManager<Config, TransportType>;
+
+        /// @brief A decoded frame and the link it came in on, only FrameSize() bytes of packet are copied
+        struct Frame {
+            uint32_t link;
+            Packet packet;
+        }; // struct Frame
+
+        public:
+        /// @param workers Worker threads, each link is decoded on one of them
+        /// @param interval Longest time in ms a link goes without an Update, see EventLoop
+        Gateway(size_t workers, unsigned long interval = 10) : running(false) {
+            for (size_t w = 0; w < (workers ? workers : 1); w++) {
+                shards.emplace_back(new Shard(this, interval));
+            }
+        }
+
+        ~Gateway() { Stop(); }
+
+        Gateway(const Gateway&) = delete;
+        Gateway& operator=(const Gateway&) = delete;
+
+
+        /// @brief Adds a link, before Start, to the worker with the fewest links
+        /// @param fd The fd transport reads, -1 to poll it instead
+        /// @return Link id frames from it are tagged with, -1 if its worker can't wait on another fd
+        inline int Add(TransportType& transport, int fd = -1) {
+            Shard* shard = shards[0].get();
+            for (auto& s : shards) {
+                if (s->links.size() < shard->links.size()) shard = s.get();
+            }
+
+            const uint32_t id = (uint32_t)byId.size();
+            std::unique_ptr<Link> link(new Link(transport, id, shard));
+
+            if (fd >= 0) {
+                if (!shard->loop.Add(fd, *link)) return -1;
+            } else {
+                shard->polled.push_back(link.get());
+            }
+
+            byId.push_back(link.get());
+            shard->links.push_back(std::move(link));
+            return (int)id;
+        }
+
+        /// @brief Starts a thread per worker
+        /// @param pin Pins worker w to core w, wrapping around the cores there are
+        inline void Start(bool pin = true) {
+            if (running) return;
+            running = true;
+
+            const unsigned cores = std::thread::hardware_concurrency();
+            for (size_t w = 0; w < shards.size(); w++) {
+                Shard& shard = *shards[w];
+                shard.thread = std::thread(&Gateway::Work, this, std::ref(shard));
+
+                if (pin && cores) {
+                    cpu_set_t set;
+                    CPU_ZERO(&set);
+                    CPU_SET(w % cores, &set);
+                    pthread_setaffinity_np(shard.thread.native_handle(), sizeof(set), &set);
+                }
+            }
+        }
+
+        /// @brief Stops and joins the workers, frames still queued stay there for Drain
+        inline void Stop() {
+            if (!running) return;
+            running = false;
+
+            for (auto& s : shards) {
+                if (s->thread.joinable()) s->thread.join();
+            }
+        }
+
+        /// @brief Hands the frames queued by the workers consumer serves to f, call it from one thread per consumer
+        ///
+        /// At most a queue's worth is taken from each worker so a busy one can't starve the others
+        /// @param consumer Which of consumers this is, it drains workers consumer, consumer+consumers...
+        /// @param f Called as f(const Frame&), the frame is only valid until it returns
+        /// @return Number of frames handed to f
+        template <typename F> inline size_t Drain(size_t consumer, size_t consumers, F&& f) {
+            size_t n = 0;
+            for (size_t w = consumer; w < shards.size(); w += consumers) {
+                SpscQueue<Frame, QUEUE>& queue = shards[w]->queue;
+
+                Frame* frame;
+                for (size_t i = 0; i < QUEUE && (frame = queue.Front()); i++) {
+                    f(static_cast<const Frame&>(*frame));
+                    queue.Pop();
+                    n++;
+                }
+            }
+
+            return n;
+        }
+
+        /// @brief Manager of a link, e.g. to read its Stats, only safe to use while the gateway is stopped
+        inline Manager& LinkManager(int id) { return byId[id]->manager; }
+
+        inline size_t Workers() const { return shards.size(); }
+        inline size_t Links() const { return byId.size(); }
+
+
+        private:
+        struct Shard;
+
+        /// @brief A link's manager, its handler is bound to it so it knows which link and queue a frame is for
+        struct Link {
+            Link(TransportType& transport, uint32_t id, Shard* shard) : manager(transport), transport(transport), id(id), shard(shard) {
+                for (size_t t = 0; t < Config::PACKET_COUNT; t++) {
+                    manager.Callback((pckt::Type)t, Manager::Delegate::template Method<Link, &Link::Forward>(*this));
+                }
+            }
+
+            inline void Update() { manager.Update(); }
+            inline pckt::SendStatus Flush() { return manager.Flush(); }
+
+            /// @brief Handler of every type, copies the frame into the worker's queue, waiting for room unless stopping
+            void Forward(const Packet& packet) {
+                SpscQueue<Frame, QUEUE>& queue = shard->queue;
+
+                Frame* frame;
+                while (!(frame = queue.Claim())) {
+                    if (!shard->gateway->running.load(std::memory_order_relaxed)) return;
+                    std::this_thread::yield();
+                }
+
+                frame->link = id;
+                memcpy(frame->packet.self(), packet.self(), packet.FrameSize());
+                queue.Push();
+            }
+
+            Manager manager;
+            TransportType& transport;
+            uint32_t id;
+            Shard* shard;
+        }; // struct Link
+
+        struct Shard {
+            Shard(Gateway* gateway, unsigned long interval) : gateway(gateway), loop(interval) {}
+
+            Gateway* gateway;
+            SpscQueue<Frame, QUEUE> queue;
+            EventLoop<SHARD_LINKS> loop;
+            std::vector<std::unique_ptr<Link>> links;
+            std::vector<Link*> polled;
+            std::thread thread;
+        }; // struct Shard
+
+        std::vector<std::unique_ptr<Shard>> shards;
+        std::vector<Link*> byId;
+        std::atomic<bool> running;
+
+        inline void Work(Shard& shard) {
+            size_t idle = 0;
+
+            while (running.load(std::memory_order_relaxed)) {
+                const int ready = shard.loop.Poll(shard.polled.empty() ? -1 : 0);
+
+                bool busy = ready > 0;
+                for (Link* link : shard.polled) {
+                    busy |= link->transport.available();
+                    link->Update();
+                }
+
+                // back off once polled links go quiet, the event loop waits on its own
+                if (busy || shard.polled.empty()) idle = 0;
+                else if (++idle > 64) std::this_thread::sleep_for(std::chrono::microseconds(50));
+            }
+        }
+    }; // struct Gateway
+
+} // namespace trns
+#endif
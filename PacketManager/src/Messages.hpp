@@ -0,0 +1,355 @@
+#pragma once
+#include "Platform.hpp"
+#include "Packet.hpp"
+
+namespace pckt {
+
+    /// @brief A reassembled message, data points into a pool buffer and is only valid during the handler
+    struct Message {
+        uint16_t type;
+        uint8_t flags;
+        const uint8_t* data;
+        size_t length;
+    }; // struct Message
+
+    using MessageHandler = void(*)(const Message&);
+
+
+    /// @brief Splits buffers larger than a payload into fragment frames and reassembles them into pool buffers,
+    /// compiled away when MESSAGE_POOL is 0
+    ///
+    /// A fragment is a frame of the message's type with the fragment flag set, its payload is
+    /// | id | index lo | index hi | data... |, the data of every fragment strung together is the message length
+    /// as two little endian bytes followed by the message. Retransmissions can reorder the fragments of critical
+    /// messages, such a message holds its slot until its last fragment is acked so the receiver never has more
+    /// than MESSAGE_POOL messages to reassemble at once. The manager it is driven by must expose OpenFrame,
+    /// CloseFrame, reliable delivery and its link counters to it
+    template <typename Config, bool Enabled = (Config::MESSAGE_POOL > 0)>
+    struct Messages {
+        using Packet = pckt::Packet<Config>;
+        using TypeId = typename Config::TypeId;
+
+        public:
+        /// @brief Sets the handler complete messages of type are passed to
+        inline void Callback(TypeId type, MessageHandler handler) { (void)type; (void)handler; }
+
+        /// @brief Takes a message to fragment, data is read from in place until every fragment has been queued
+        /// @return False if MESSAGE_POOL messages are still being sent
+        inline bool Queue(TypeId type, uint8_t flags, uint8_t channel, const uint8_t* data, size_t len) {
+            (void)type; (void)flags; (void)channel; (void)data; (void)len;
+            return false;
+        }
+
+        /// @brief Sends as many fragments as the manager takes, one message after the other in turn
+        template <typename Manager> inline void Pump(Manager& manager) { (void)manager; }
+
+        /// @brief Reassembles a verified packet if it is a fragment
+        /// @return True if the packet was a fragment and must not reach the packet handler
+        template <typename Manager> inline bool Accept(Manager& manager, const Packet& packet) {
+            (void)manager; (void)packet;
+            return false;
+        }
+
+        /// @brief Drops messages that haven't received a fragment for MESSAGE_TIMEOUT ms
+        template <typename Manager> inline void Expire(Manager& manager) { (void)manager; }
+
+        /// @brief Number of messages not fully queued yet, or critical and not acked yet
+        inline size_t Pending() const { return 0; }
+    }; // struct Messages
+
+
+    template <typename Config> struct Messages<Config, true> {
+        using Packet = pckt::Packet<Config>;
+        using TypeId = typename Config::TypeId;
+
+        static constexpr uint8_t FRAGMENT_FLAG = 0b01000000;
+
+        // id and index in front of the data of every fragment, the length in front of the message
+        static constexpr size_t FRAGMENT_HEADER = 3;
+        static constexpr size_t LENGTH_SIZE = 2;
+
+        /// @brief Stream bytes each fragment carries
+        static constexpr size_t CHUNK = Config::MAX_PAYLOAD_SIZE - FRAGMENT_HEADER;
+
+        /// @brief Most fragments a message can take
+        static constexpr size_t FRAGMENTS = (LENGTH_SIZE + Config::MAX_MESSAGE_SIZE + CHUNK - 1) / CHUNK;
+
+        static_assert(Config::MAX_PAYLOAD_SIZE > FRAGMENT_HEADER + LENGTH_SIZE, "fragments need 6 payload bytes");
+        static_assert(Config::MAX_MESSAGE_SIZE > 0 && Config::MAX_MESSAGE_SIZE <= 0xFFFF, "message length must fit two bytes");
+
+        public:
+        Messages() {
+            for (size_t t = 0; t < Config::PACKET_COUNT; t++) {
+                handlers[t] = nullptr;
+            }
+
+            for (size_t i = 0; i < Config::MESSAGE_POOL; i++) {
+                pool[i].used = false;
+                outbox[i].active = false;
+            }
+
+            nextId = 0;
+            assembling = 0;
+        }
+
+        inline void Callback(TypeId type, MessageHandler handler) {
+            if (type < Config::PACKET_COUNT) handlers[type] = handler;
+        }
+
+        inline bool Queue(TypeId type, uint8_t flags, uint8_t channel, const uint8_t* data, size_t len) {
+            for (size_t i = 0; i < Config::MESSAGE_POOL; i++) {
+                Outgoing& out = outbox[i];
+                if (out.active) continue;
+
+                out.active = true;
+                out.queued = false;
+                out.data = data;
+                out.length = (uint16_t)len;
+                out.next = 0;
+                out.id = nextId++;
+                out.type = type;
+                out.flags = flags | FRAGMENT_FLAG;
+                out.channel = channel;
+                return true;
+            }
+
+            return false;
+        }
+
+        template <typename Manager> inline void Pump(Manager& manager) {
+            // a fragment of each message in turn, so a long message doesn't hold up the ones queued after it
+            bool sent = true;
+            while (sent) {
+                sent = false;
+
+                for (size_t i = 0; i < Config::MESSAGE_POOL; i++) {
+                    Outgoing& out = outbox[i];
+                    if (!out.active) continue;
+
+                    if (out.queued) {
+                        if (manager.reliability.Acked(out.lastSeq)) out.active = false;
+                        continue;
+                    }
+
+                    if (!SendFragment(manager, out)) return;
+                    sent = true;
+                }
+            }
+        }
+
+        template <typename Manager> inline bool Accept(Manager& manager, const Packet& packet) {
+            if (!(packet.flags & FRAGMENT_FLAG)) return false;
+
+            // too short to be a fragment, or nobody wants the message
+            const size_t carried = packet.PayloadLength();
+            if (carried <= FRAGMENT_HEADER || packet.type >= Config::PACKET_COUNT || !handlers[packet.type]) return true;
+
+            const uint8_t id = packet.payload[0];
+            const size_t index = (size_t)packet.payload[1] | ((size_t)packet.payload[2] << 8);
+            const uint8_t* data = packet.payload + FRAGMENT_HEADER;
+            size_t stream = index * CHUNK;
+            size_t len = carried - FRAGMENT_HEADER;
+            if (index >= FRAGMENTS || (index == 0 && len < LENGTH_SIZE)) return true;
+
+            // fragment 0 carries the length, the message is complete once that many fragments are in
+            Assembly* assembly = Find(manager, id, packet.type, index == 0);
+            if (Has(*assembly, index)) return true;
+            if (assembly->sized && index >= assembly->count) return true;
+            Mark(*assembly, index);
+
+            if (index == 0) {
+                const size_t length = (size_t)data[0] | ((size_t)data[1] << 8);
+                if (length > Config::MAX_MESSAGE_SIZE) {
+                    Drop(manager, *assembly);
+                    return true;
+                }
+
+                assembly->length = (uint16_t)length;
+                assembly->count = (uint16_t)((LENGTH_SIZE + length + CHUNK - 1) / CHUNK);
+                assembly->sized = true;
+                Trim(*assembly);
+                data += LENGTH_SIZE;
+                stream += LENGTH_SIZE;
+                len -= LENGTH_SIZE;
+            }
+
+            // copied once, from the verified frame straight into the pool buffer
+            const size_t offset = stream - LENGTH_SIZE;
+            if (offset < Config::MAX_MESSAGE_SIZE) {
+                if (len > Config::MAX_MESSAGE_SIZE - offset) len = Config::MAX_MESSAGE_SIZE - offset;
+                memcpy(assembly->data + offset, data, len);
+            }
+
+            assembly->flags = packet.flags & ~FRAGMENT_FLAG;
+            assembly->lastAt = Millis();
+
+            if (assembly->sized && assembly->received == assembly->count) {
+                const Message message = { assembly->type, assembly->flags, assembly->data, assembly->length };
+                Release(*assembly);
+                handlers[message.type](message);
+            }
+
+            return true;
+        }
+
+        template <typename Manager> inline void Expire(Manager& manager) {
+            if (!assembling) return;
+
+            const unsigned long now = Millis();
+            for (size_t i = 0; i < Config::MESSAGE_POOL; i++) {
+                if (pool[i].used && (now - pool[i].lastAt) > Config::MESSAGE_TIMEOUT) Drop(manager, pool[i]);
+            }
+        }
+
+        inline size_t Pending() const {
+            size_t n = 0;
+            for (size_t i = 0; i < Config::MESSAGE_POOL; i++) {
+                if (outbox[i].active) n++;
+            }
+            return n;
+        }
+
+
+        private:
+        struct Outgoing {
+            const uint8_t* data;
+            uint16_t length;
+            uint16_t next; // index of the next fragment to send
+            uint8_t id;
+            TypeId type;
+            uint8_t flags;
+            uint8_t channel;
+            uint8_t lastSeq; // sequence number of the last fragment when critical
+            bool queued;     // every fragment is in the manager's hands
+            bool active;
+        }; // struct Outgoing
+
+        struct Assembly {
+            uint8_t data[Config::MAX_MESSAGE_SIZE];
+            uint8_t seen[(FRAGMENTS + 7) / 8];
+            uint16_t received; // fragments in so far
+            uint16_t count;    // fragments in the message, known once fragment 0 is in
+            uint16_t length;
+            unsigned long lastAt;
+            uint8_t id;
+            TypeId type;
+            uint8_t flags;
+            bool sized;
+            bool used;
+        }; // struct Assembly
+
+        MessageHandler handlers[Config::PACKET_COUNT];
+        Outgoing outbox[Config::MESSAGE_POOL];
+        Assembly pool[Config::MESSAGE_POOL];
+        uint8_t nextId;
+        uint8_t assembling; // pool buffers in use
+
+
+        /// @brief Builds the next fragment of a message straight from its buffer into the manager's tx queue
+        /// @return False if the manager can't take a frame now
+        template <typename Manager> inline bool SendFragment(Manager& manager, Outgoing& out) {
+            const size_t stream = (size_t)out.next * CHUNK;
+            const size_t total = LENGTH_SIZE + out.length;
+            const size_t len = total - stream < CHUNK ? total - stream : CHUNK;
+
+            Packet* frame = manager.OpenFrame(out.type, out.flags, out.channel, FRAGMENT_HEADER + len);
+            if (!frame) return false;
+
+            uint8_t* payload = frame->payload;
+            payload[0] = out.id;
+            payload[1] = (uint8_t)out.next;
+            payload[2] = (uint8_t)(out.next >> 8);
+            payload += FRAGMENT_HEADER;
+
+            if (out.next == 0) {
+                payload[0] = (uint8_t)out.length;
+                payload[1] = (uint8_t)(out.length >> 8);
+                if (out.length) memcpy(payload + LENGTH_SIZE, out.data, len - LENGTH_SIZE);
+            } else {
+                memcpy(payload, out.data + stream - LENGTH_SIZE, len);
+            }
+
+            // critical fragments are numbered as they are committed
+            const uint8_t seq = manager.reliability.NextSequence();
+            manager.CloseFrame(*frame);
+
+            out.next++;
+            if (stream + len == total) {
+                out.queued = true;
+                out.lastSeq = seq;
+                if (!(out.flags & 0b10000000)) out.active = false;
+            }
+            return true;
+        }
+
+        /// @brief Pool buffer the message id of type is reassembled in, the least recently active one is given up
+        /// if none is free
+        /// @param restart Fragment 0 of a message whose earlier one with the same id is still held starts it over
+        template <typename Manager> inline Assembly* Find(Manager& manager, uint8_t id, TypeId type, bool restart) {
+            Assembly* oldest = nullptr;
+            Assembly* free = nullptr;
+
+            for (size_t i = 0; i < Config::MESSAGE_POOL; i++) {
+                Assembly& a = pool[i];
+                if (!a.used) {
+                    if (!free) free = &a;
+                    continue;
+                }
+
+                if (a.id == id && a.type == type) {
+                    if (!(restart && a.sized)) return &a;
+
+                    Drop(manager, a);
+                    free = &a;
+                    break;
+                }
+
+                if (!oldest || (long)(a.lastAt - oldest->lastAt) < 0) oldest = &a;
+            }
+
+            if (!free) {
+                Drop(manager, *oldest);
+                free = oldest;
+            }
+
+            free->used = true;
+            free->sized = false;
+            free->received = 0;
+            free->id = id;
+            free->type = type;
+            free->lastAt = Millis();
+            memset(free->seen, 0, sizeof(free->seen));
+            assembling++;
+            return free;
+        }
+
+        static inline bool Has(const Assembly& a, size_t index) { return a.seen[index >> 3] & (1u << (index & 7)); }
+
+        static inline void Mark(Assembly& a, size_t index) {
+            a.seen[index >> 3] |= (1u << (index & 7));
+            a.received++;
+        }
+
+        /// @brief Forgets fragments past the count fragment 0 gave, they came before it and aren't part of the message
+        static inline void Trim(Assembly& a) {
+            a.received = 0;
+            for (size_t index = 0; index < FRAGMENTS; index++) {
+                if (!Has(a, index)) continue;
+                if (index < a.count) a.received++;
+                else a.seen[index >> 3] &= (uint8_t)~(1u << (index & 7));
+            }
+        }
+
+        inline void Release(Assembly& a) {
+            a.used = false;
+            assembling--;
+        }
+
+        /// @brief Gives up an incomplete message
+        template <typename Manager> inline void Drop(Manager& manager, Assembly& a) {
+            manager.stats.MessageDropped();
+            Release(a);
+        }
+    }; // struct Messages
+
+} // namespace pckt
@@ -0,0 +1,176 @@
+#pragma once
+#include "Platform.hpp"
+#include "Packet.hpp"
+
+namespace pckt {
+
+    /// @brief Token bucket that holds the bytes written to the transport to TX_RATE per second, compiled away
+    /// when TX_RATE is 0
+    ///
+    /// Tokens accrue at TX_RATE bytes per second up to the burst, every byte written takes one, so an idle link
+    /// can write a burst back to back and a busy one averages out at TX_RATE
+    /// @tparam Burst Bucket depth in bytes
+    template <typename Config, size_t Burst, bool Enabled = (Config::TX_RATE > 0)>
+    struct Pacer {
+        public:
+        /// @brief Bytes that may be written now
+        inline size_t Budget() { return SIZE_MAX; }
+
+        /// @brief Takes n written bytes out of the budget
+        inline void Spent(size_t n) { (void)n; }
+    }; // struct Pacer
+
+
+    template <typename Config, size_t Burst> struct Pacer<Config, Burst, true> {
+        // the leftover byte-microseconds of a refill stay below Burst*1000000
+        static_assert(Burst <= 4000, "the tx burst must be at most 4000 bytes");
+
+        /// @brief Microseconds an empty bucket takes to fill
+        static constexpr unsigned long FILL_TIME = (unsigned long)(Burst * 1000000ul / Config::TX_RATE);
+
+        public:
+        Pacer() : tokens(Burst), carry(0), refilledAt(Micros()) {}
+
+        inline size_t Budget() {
+            const unsigned long now = Micros();
+            const unsigned long elapsed = now - refilledAt;
+            refilledAt = now;
+
+            if (elapsed >= FILL_TIME) {
+                tokens = Burst;
+                carry = 0;
+                return tokens;
+            }
+
+            // whole bytes accrued, the fraction carries over so the rate doesn't drift with the update rate
+            carry += (uint32_t)elapsed * (uint32_t)Config::TX_RATE;
+            tokens += carry / 1000000u;
+            carry %= 1000000u;
+            if (tokens > Burst) tokens = Burst;
+
+            return tokens;
+        }
+
+        inline void Spent(size_t n) { tokens = n < tokens ? tokens - n : 0; }
+
+
+        private:
+        size_t tokens;
+        uint32_t carry; // byte-microseconds short of the next whole token
+        unsigned long refilledAt;
+    }; // struct Pacer
+
+
+    /// @brief Holds the newest payload of each type Config::Coalesced picks and channel until the link has room
+    /// for it, compiled away when COALESCE_SLOTS is 0
+    ///
+    /// A payload sent while an older one of its type and channel is still held replaces it, so a type sent faster
+    /// than the link drains never builds up a backlog, whatever reaches the wire is the newest value. Held
+    /// payloads are built into frames only once the pacer could write them along with everything queued ahead
+    /// of them, one held payload after the other in turn. The manager it is driven by must expose OpenFrame,
+    /// CloseFrame and CanWriteNow to it
+    template <typename Config, bool Enabled = (Config::COALESCE_SLOTS > 0)>
+    struct Coalescer {
+        using TypeId = typename Config::TypeId;
+
+        public:
+        /// @brief Checks a payload of type is held rather than queued
+        inline bool Holds(TypeId type, uint8_t flags) const { (void)type; (void)flags; return false; }
+
+        /// @brief Holds a payload, replacing the one held for its type and channel
+        /// @return False if every slot holds another type
+        inline bool Store(TypeId type, uint8_t flags, uint8_t channel, const uint8_t* payload, size_t len) {
+            (void)type; (void)flags; (void)channel; (void)payload; (void)len;
+            return false;
+        }
+
+        /// @brief Builds held payloads into frames while the link has room for them
+        template <typename Manager> inline void Pump(Manager& manager) { (void)manager; }
+
+        /// @brief Number of payloads held
+        inline size_t Held() const { return 0; }
+    }; // struct Coalescer
+
+
+    template <typename Config> struct Coalescer<Config, true> {
+        using Packet = pckt::Packet<Config>;
+        using TypeId = typename Config::TypeId;
+
+        static_assert(Config::COALESCE_SLOTS <= 255, "at most 255 coalesce slots");
+
+        public:
+        Coalescer() : next(0), held(0) {
+            for (size_t i = 0; i < Config::COALESCE_SLOTS; i++) slots[i].held = false;
+        }
+
+        // critical packets each need their ack, they are never replaced
+        inline bool Holds(TypeId type, uint8_t flags) const {
+            return !(flags & 0b10000000) && Config::Coalesced(type);
+        }
+
+        inline bool Store(TypeId type, uint8_t flags, uint8_t channel, const uint8_t* payload, size_t len) {
+            Slot* slot = nullptr;
+            for (size_t i = 0; i < Config::COALESCE_SLOTS; i++) {
+                Slot& s = slots[i];
+                if (s.held && s.type == type && s.channel == channel) {
+                    slot = &s;
+                    break;
+                }
+
+                if (!s.held && !slot) slot = &s;
+            }
+
+            if (!slot) return false;
+            if (!slot->held) held++;
+
+            slot->held = true;
+            slot->type = type;
+            slot->flags = flags;
+            slot->channel = channel;
+            slot->len = (uint16_t)len;
+            if (payload) memcpy(slot->payload, payload, len);
+            else memset(slot->payload, 0, len);
+            return true;
+        }
+
+        template <typename Manager> inline void Pump(Manager& manager) {
+            const size_t first = next;
+            for (size_t n = 0; held && n < Config::COALESCE_SLOTS; n++) {
+                const size_t i = (first + n) % Config::COALESCE_SLOTS;
+                Slot& slot = slots[i];
+                if (!slot.held) continue;
+
+                if (!manager.CanWriteNow(Manager::MAX_FRAME_SIZE)) return;
+
+                // a channel out of room doesn't hold up the others
+                Packet* frame = manager.OpenFrame(slot.type, slot.flags, slot.channel, slot.len);
+                if (!frame) continue;
+
+                memcpy(frame->payload, slot.payload, slot.len);
+                manager.CloseFrame(*frame);
+
+                slot.held = false;
+                held--;
+                next = (uint8_t)((i + 1) % Config::COALESCE_SLOTS);
+            }
+        }
+
+        inline size_t Held() const { return held; }
+
+
+        private:
+        struct Slot {
+            uint8_t payload[Config::MAX_PAYLOAD_SIZE];
+            TypeId type;
+            uint8_t flags;
+            uint8_t channel;
+            uint16_t len;
+            bool held;
+        }; // struct Slot
+
+        Slot slots[Config::COALESCE_SLOTS];
+        uint8_t next; // slot pumped first next time, so every held payload gets its turn
+        uint8_t held;
+    }; // struct Coalescer
+
+} // namespace pckt
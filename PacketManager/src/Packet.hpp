@@ -0,0 +1,191 @@
+#pragma once
+#include <stdint.h>
+#include <stddef.h>
+#include "Checksum.hpp"
+
+namespace pckt {
+
+    /// @brief Types of packets that can be sent / recieved
+    enum class Type {
+        None,
+        DataPacket,
+        AckPacket,
+    }; // enum Type
+
+
+    /// @brief Outcome of handing a packet to the PacketManager
+    enum class SendStatus {
+        Sent,       // every pending byte reached the transport
+        Queued,     // accepted, some bytes wait in the tx queue for Flush / Update
+        WouldBlock, // rejected, the tx queue has no room until Update drains it
+        TooLarge,   // rejected, a message longer than MAX_MESSAGE_SIZE
+    }; // enum SendStatus
+
+
+    /// @brief How frames are found in the byte stream
+    enum class Framing {
+        Magic, // frames start with MAGIC_NUM, which may also appear inside them
+        Cobs,  // frames are COBS stuffed and end with a 0x00 that appears nowhere else
+    }; // enum Framing
+
+
+    /// @brief How queued frames from different channels are ordered onto the wire
+    enum class Schedule {
+        Strict,   // lower numbered channels always go first, call order within a channel
+        Weighted, // channel 0 goes first, the others share the link in proportion to Config::TxWeight
+    }; // enum Schedule
+
+
+    /// @brief Default link configuration, derive from it and shadow what needs to change
+    ///
+    /// struct TelemetryConfig : pckt::DefaultConfig {
+    ///     static constexpr size_t MAX_PAYLOAD_SIZE = 64;
+    ///     static constexpr bool VARIABLE_LENGTH = true;
+    /// };
+    struct DefaultConfig {
+        // ms a partially received packet may wait for the rest of its bytes
+        static constexpr unsigned long READ_TIMEOUT = 100;
+
+        static constexpr size_t MAX_PAYLOAD_SIZE = 8;
+        static constexpr uint8_t MAGIC_NUM = 0xAA;
+
+        // type field on the wire, uint16_t for ids past 255
+        using TypeId = uint8_t;
+
+        // types below PACKET_COUNT have a slot each in a flat handler table
+        static constexpr size_t PACKET_COUNT = 3;
+
+        // handlers that can be set for types at or above PACKET_COUNT, found through a perfect hash, see
+        // SparseHandlers, at most 254, 0 compiles the table away and such types are dropped as bad types
+        static constexpr size_t SPARSE_HANDLERS = 0;
+
+        // Framing::Cobs costs one delimiter byte per frame, resyncs at the next delimiter and can't lock onto
+        // a false frame start, frames can then be at most 255 bytes
+        static constexpr Framing FRAMING = Framing::Magic;
+
+        // checksum policy, one of chk::Fletcher16, chk::Crc16Ccitt or chk::Crc32<N>
+        using Checksum = chk::Fletcher16;
+
+        // bytes pulled per read from transports without spans, frames are then decoded in place
+        // 0 reads one frame at a time straight into the rx packet, which uses the least RAM
+        static constexpr size_t RX_BATCH_SIZE = 0;
+
+        // true sends a payload length byte and only the bytes used, MAX_PAYLOAD_SIZE can then be up to 255
+        // false always sends MAX_PAYLOAD_SIZE bytes, the original fixed size frame
+        static constexpr bool VARIABLE_LENGTH = false;
+
+        // bytes of outbound frames held until Flush, 0 writes every frame as it is sent
+        static constexpr size_t TX_QUEUE_SIZE = 0;
+
+        // ms a queued frame may wait before Update flushes it
+        static constexpr unsigned long TX_FLUSH_TIMEOUT = 10;
+
+        // outbound channels, see PacketManager::SetChannel, more than 1 reorders frames waiting in the tx queue
+        // so the queue must be on, critical packets always go on channel 0
+        static constexpr uint8_t TX_CHANNELS = 1;
+        static constexpr Schedule TX_SCHEDULE = Schedule::Strict;
+
+        // share of the link and of the tx queue channel c gets under Schedule::Weighted, relative to the other
+        // channels, at least 1
+        static constexpr uint8_t TxWeight(uint8_t) { return 1; }
+
+        // bytes per second written to the transport, 0 writes as fast as it takes them, needs the tx queue
+        // e.g. 960 for a 9600 baud serial link
+        static constexpr unsigned long TX_RATE = 0;
+
+        // bytes that can be written back to back after the link was idle, at least a frame and at most 4000,
+        // 0 is one full size frame
+        static constexpr size_t TX_BURST = 0;
+
+        // types whose newest payload is held until the link has room instead of queued behind the older ones,
+        // a slot per type and channel held at once, 0 disables coalescing, see Coalescer
+        static constexpr size_t COALESCE_SLOTS = 0;
+
+        // types Send coalesces
+        static constexpr bool Coalesced(uint16_t type) { return type == (uint16_t)Type::DataPacket; }
+
+        // critical packets that can be awaiting an ack at once, power of two up to 32, 0 disables reliable delivery
+        static constexpr uint8_t RELIABLE_WINDOW = 0;
+
+        // bounds in ms for the adaptive retransmission timeout of critical packets, starts at the initial value
+        static constexpr unsigned long RELIABLE_INITIAL_RTO = 250;
+        static constexpr unsigned long RELIABLE_MIN_RTO = 20;
+        static constexpr unsigned long RELIABLE_MAX_RTO = 4000;
+
+        // messages larger than a payload that can be reassembled at once, and sent at once, 0 disables messages
+        // every one holds a MAX_MESSAGE_SIZE buffer, see PacketManager::SendMessage
+        static constexpr size_t MESSAGE_POOL = 0;
+        static constexpr size_t MAX_MESSAGE_SIZE = 256;
+
+        // ms an incomplete message may wait for its next fragment before it is dropped
+        static constexpr unsigned long MESSAGE_TIMEOUT = 500;
+
+        // every how many frames of a delta coded type is a keyframe, the others only carry the bytes that changed
+        // since it, 0 disables delta coding, needs VARIABLE_LENGTH
+        static constexpr size_t DELTA_KEYFRAME = 0;
+
+        // types whose payloads Send delta codes
+        static constexpr bool DeltaCoded(uint16_t type) { return type == (uint16_t)Type::DataPacket; }
+
+        // true keeps the counters behind PacketManager::Stats, false compiles them away
+        static constexpr bool STATS = false;
+    }; // struct DefaultConfig
+
+
+    // The header is built up in layers so optional fields only exist, and only go on the wire,
+    // for configurations that use them: magic, type, flags, [seq], [len]
+
+    template <typename Config> struct __attribute__((packed)) BaseHeader {
+        public:
+        uint8_t magic = Config::MAGIC_NUM;
+        typename Config::TypeId type;
+
+        // 8th bit -> | critical | fragment | delta | tbd | user#4 | user#3 | user#2 | user#1 | <- 1st bit
+        uint8_t flags;
+    }; // struct BaseHeader
+
+    template <typename Config, bool Reliable = (Config::RELIABLE_WINDOW > 0)>
+    struct __attribute__((packed)) SequencedHeader : public BaseHeader<Config> {};
+
+    template <typename Config> struct __attribute__((packed)) SequencedHeader<Config, true> : public BaseHeader<Config> {
+        public:
+        // sequence number of a critical packet, unused by everything else
+        uint8_t seq;
+    }; // struct SequencedHeader
+
+    template <typename Config, bool Variable = Config::VARIABLE_LENGTH>
+    struct __attribute__((packed)) PacketHeader : public SequencedHeader<Config> {
+        public:
+        inline size_t PayloadLength() const { return Config::MAX_PAYLOAD_SIZE; }
+        inline void SetPayloadLength(size_t len) { (void)len; }
+    }; // struct PacketHeader
+
+    template <typename Config> struct __attribute__((packed)) PacketHeader<Config, true> : public SequencedHeader<Config> {
+        public:
+        // payload bytes on the wire, the checksum follows them directly so only payload[0, len) is valid
+        uint8_t len;
+
+        inline size_t PayloadLength() const { return len; }
+        inline void SetPayloadLength(size_t v) { len = (uint8_t)v; }
+    }; // struct PacketHeader
+
+
+    /// @brief General packet format
+    template <typename Config = DefaultConfig> struct __attribute__((packed)) Packet : public PacketHeader<Config> {
+        public:
+        using Checksum = typename Config::Checksum;
+
+        /// @brief Number of frame bytes before the payload
+        static constexpr size_t HEADER_SIZE = sizeof(PacketHeader<Config>);
+
+        uint8_t payload[Config::MAX_PAYLOAD_SIZE];
+        typename Checksum::Type checksum;
+
+        inline uint8_t* self() { return reinterpret_cast<uint8_t*>(this); }
+        inline const uint8_t* self() const { return reinterpret_cast<const uint8_t*>(this); }
+
+        /// @brief Number of bytes on the wire, the header must be complete
+        inline size_t FrameSize() const { return HEADER_SIZE + this->PayloadLength() + sizeof(checksum); }
+    }; // struct Packet
+
+} // namespace pckt
@@ -1,92 +1,177 @@
 #pragma once
-#include <Arduino.h>
-#include <SoftwareSerial.h>
-
-#define READ_TIMEOUT 100
-#define MAX_PAYLOAD_SIZE 8
-#define PACKET_COUNT 3
-#define MAGIC_NUM 0xAA
+#include "Platform.hpp"
+#include "Checksum.hpp"
+#include "Cobs.hpp"
+#include "Delta.hpp"
+#include "Dispatch.hpp"
+#include "Messages.hpp"
+#include "Packet.hpp"
+#include "Pacing.hpp"
+#include "Reliability.hpp"
+#include "Scheduler.hpp"
+#include "Schema.hpp"
+#include "Stats.hpp"
+#include "Transport.hpp"
 
 namespace pckt {
 
-    /// @brief Types of packets that can be sent / recieved
-    enum class Type {
-        None,
-        DataPacket,
-        AckPacket,
-    }; // enum Type
-
+    /// @brief Fixed size byte buffer that takes no space when N is 0
+    template <size_t N> struct Buffer {
+        uint8_t bytes[N];
+        inline uint8_t* data() { return bytes; }
+        inline const uint8_t* data() const { return bytes; }
+    }; // struct Buffer
 
-    /// @brief General packet format
-    struct __attribute__((packed)) Packet {
-        public:
-        uint8_t magic = MAGIC_NUM;
-        uint8_t type;
-       
-        // 8th bit -> | critical | tbd | tbd | tbd | user#4 | user#3 | user#2 | user#1 | <- 1st bit
-        uint8_t flags;
+    template <> struct Buffer<0> {
+        inline uint8_t* data() { return nullptr; }
+        inline const uint8_t* data() const { return nullptr; }
+    }; // struct Buffer
 
-        uint8_t payload[MAX_PAYLOAD_SIZE];
-        uint16_t checksum;
 
-        inline uint8_t* self() { return reinterpret_cast<uint8_t*>(this); }
-        inline const uint8_t* self() const { return reinterpret_cast<const uint8_t*>(this); }
-    }; // struct Packet
+    /// @brief Manages sending and recieving packets
+    /// @tparam Config Link configuration, see DefaultConfig
+    /// @tparam TransportType Transport the manager is bound to, Transport dispatches through the vtable,
+    /// a concrete final transport or one built on StaticTransport is called directly and inlines into the parse loop
+    template <typename Config = DefaultConfig, typename TransportType = Transport> struct PacketManager {
+        using Packet = pckt::Packet<Config>;
+        using Checksum = typename Config::Checksum;
+        using Handler = void(*)(const Packet&);
+        using Delegate = pckt::Delegate<Packet>;
+        using TypeId = typename Config::TypeId;
 
+        static constexpr bool COBS = Config::FRAMING == Framing::Cobs;
 
-    /// @brief Transport layer abstraction
-    struct Transport {
-        public:
-        virtual int read(uint8_t* data, size_t len) = 0;
-        virtual size_t write(const uint8_t* data, size_t len) = 0;
+        /// @brief Most bytes a frame takes on the wire, COBS adds the delimiter
+        static constexpr size_t MAX_FRAME_SIZE = sizeof(Packet) + (COBS ? 1 : 0);
 
-        virtual bool available() = 0;
-    }; // struct Transport
+        // a failed candidate's checksum slides along to the next one instead of being summed again,
+        // variable lengths change how many bytes each candidate covers so they sum from scratch
+        static constexpr bool ROLLING = Checksum::ROLLING && !Config::VARIABLE_LENGTH;
 
+        static_assert(!Config::VARIABLE_LENGTH || Config::MAX_PAYLOAD_SIZE <= 255, "variable length payloads must fit the length byte");
+        static_assert(Config::TX_QUEUE_SIZE == 0 || Config::TX_QUEUE_SIZE >= MAX_FRAME_SIZE, "tx queue must fit at least one frame");
+        static_assert(!COBS || sizeof(Packet) <= cobs::MAX_FRAME, "cobs frames are stuffed in place and must be at most 255 bytes");
+        static_assert(Config::TX_CHANNELS >= 1, "there must be at least one channel");
+        static_assert(Config::TX_CHANNELS == 1 || Config::TX_QUEUE_SIZE >= 2*MAX_FRAME_SIZE, "channels need a tx queue with room for channel 0 to overtake a full frame");
+        static_assert(Config::PACKET_COUNT <= (size_t)(TypeId)~(TypeId)0 + 1, "every type below PACKET_COUNT must fit TypeId");
+        static_assert(Config::TX_RATE == 0 || Config::TX_QUEUE_SIZE > 0, "pacing holds frames in the tx queue");
+        static_assert(Config::TX_BURST == 0 || Config::TX_BURST >= MAX_FRAME_SIZE, "the tx burst must fit a full size frame");
 
-    /// @brief Manages sending and recieving packets
-    struct PacketManager {
-        using Handler = void(*)(const Packet&);
+        template <typename, bool> friend struct Reliability;
+        template <typename, bool> friend struct Messages;
+        template <typename, bool> friend struct Coalescer;
 
         public:
-        PacketManager(Transport& transport) : transport(transport) {
-            for(size_t i = 0; i < PACKET_COUNT; i++) {
+        PacketManager(TransportType& transport) : transport(transport) {
+            for(size_t i = 0; i < Config::PACKET_COUNT; i++) {
                 handlers[i] = nullptr;
             }
 
-            memset(&txPacket, 0, sizeof(Packet));
-            memset(&rxPacket, 0, sizeof(Packet));
-            txPacket.magic = MAGIC_NUM;
+            memset(rxWindow.data(), 0, RX_WINDOW);
+
+            txFlags = 0;
+            txChannel = 0;
+            txOpenChannel = 0;
+            txOpen = nullptr;
+            txHead = 0;
+            txQueued = 0;
+            txQueuedAt = 0;
 
             ResetState();
         }
 
         /// @brief Checks transport buffer for data and attempts to parse packet
         inline void Update() {
+            stats.UpdateStarted();
+
+            // the newest held payloads go out as the link makes room
+            latest.Pump(*this);
+
+            // resume a partial write, keep a paced link busy, or don't let queued frames go stale
+            if (Pending()) {
+                if (Config::TX_QUEUE_SIZE == 0 || Config::TX_RATE > 0 || txHead || (Millis()-txQueuedAt) >= Config::TX_FLUSH_TIMEOUT) {
+                    Flush();
+                }
+            }
+
+            reliability.Retransmit(*this);
+            messages.Pump(*this);
+            messages.Expire(*this);
+
             if (!transport.available()) {
 
                 // message timed out, reset state
-                if (reading && (millis()-receivedAt) > READ_TIMEOUT) {
+                if (reading && (Millis()-receivedAt) > Config::READ_TIMEOUT) {
+                    stats.Timeout(bytesRead);
                     ResetState();
                 }
 
                 return; 
             }
 
-            while (transport.available()) { TryReadPacket(); }
+            while (transport.available()) {
+                // decode straight out of the transport's memory when it has some
+                const uint8_t* span;
+                size_t len = transport.peek(span);
+                if (len) {
+                    stats.BytesIn(len);
+                    Decode(span, len);
+                    transport.consume(len);
+                    continue;
+                }
+
+                if (Config::RX_BATCH_SIZE > 0) {
+                    int recv = transport.read(rxBatch.data(), Config::RX_BATCH_SIZE);
+                    if (recv > 0) {
+                        stats.BytesIn(recv);
+                        Decode(rxBatch.data(), recv);
+                    }
+                } else {
+                    TryReadPacket();
+                }
+            }
+
+            // the candidate a resync moved to started arriving during this update
+            if (restamp) {
+                receivedAt = Millis();
+                restamp = false;
+            }
         }
 
 
         /// @brief Sets callback function when a packet is recieved
+        ///
+        /// Types below PACKET_COUNT index a flat table, any other type that fits TypeId goes in the sparse table
+        /// when SPARSE_HANDLERS is above 0, both are a constant time lookup
         /// @param type Type of packet this handler applies to
-        /// @param handler Pointer to handler function
-        inline void Callback(Type type, Handler handler) {
-            int t = (int)type;
-            if (t < 0 || t >= PACKET_COUNT) {
-                return;
+        /// @param handler Pointer to handler function or a Delegate bound to an object, empty clears it
+        /// @return False if type is out of range or the sparse table has no room for it
+        inline bool Callback(Type type, Delegate handler) {
+            long t = (long)type;
+            if (t < 0 || (unsigned long)t > (TypeId)~(TypeId)0) {
+                return false;
             }
-           
+
+            if ((size_t)t >= Config::PACKET_COUNT) {
+                return sparse.Set((TypeId)t, handler);
+            }
+
             handlers[t] = handler;
+            return true;
+        }
+
+
+        /// @brief Sets the handler for the message struct T, see Schema
+        ///
+        /// When T's wire layout matches memory and T has no alignment the handler gets a view straight into the
+        /// received frame, otherwise T is decoded into a local first. Frames too short for T are dropped
+        /// @tparam handler Function called with every T received
+        template <typename T, void(*handler)(const T&)> inline bool Callback() {
+            using S = Schema<T>;
+            static_assert(S::TYPE < Config::PACKET_COUNT || Config::SPARSE_HANDLERS > 0, "message type must be below PACKET_COUNT without sparse handlers");
+            static_assert(S::TYPE <= (TypeId)~(TypeId)0, "message type must fit TypeId");
+
+            return Callback((Type)S::TYPE, &Typed<T, handler>::Call);
         }
 
 
@@ -94,19 +179,152 @@ namespace pckt {
         /// @param type Type of packet to send
         /// @param payload Packet payload
         /// @param len Number of bytes in packet payload
-        inline void Send(Type type, const uint8_t* payload, size_t len) {
-            txPacket.magic = MAGIC_NUM;
-            txPacket.type = (uint8_t)type;
-            memset(txPacket.payload, 0, MAX_PAYLOAD_SIZE);
+        /// @return WouldBlock if nothing was sent because earlier frames are still waiting on the transport,
+        /// or for a critical packet when RELIABLE_WINDOW packets are still awaiting an ack. A coalesced type is
+        /// Queued while it is held, replacing the payload held before it, see COALESCE_SLOTS
+        inline SendStatus Send(Type type, const uint8_t* payload, size_t len) {
+            if (len > Config::MAX_PAYLOAD_SIZE) len = Config::MAX_PAYLOAD_SIZE;
+
+            if (latest.Holds((TypeId)type, txFlags) && latest.Store((TypeId)type, txFlags, txChannel, payload, len)) {
+                latest.Pump(*this);
+                return latest.Held() || Pending() ? SendStatus::Queued : SendStatus::Sent;
+            }
+            if (delta.Codes((TypeId)type, payload, len)) return SendDelta((TypeId)type, payload, len);
+            return SendFrame((TypeId)type, txFlags, payload, len);
+        }
+
+
+        /// @brief Sends a message struct with the type and wire layout registered for it, see Schema
+        ///
+        /// When T's wire layout matches memory it is copied straight into the frame, otherwise it is encoded first
+        template <typename T> inline SendStatus Send(const T& msg) {
+            using S = Schema<T>;
+            static_assert(S::SIZE <= Config::MAX_PAYLOAD_SIZE, "message doesn't fit MAX_PAYLOAD_SIZE");
+            static_assert(S::TYPE < Config::PACKET_COUNT || Config::SPARSE_HANDLERS > 0, "message type must be below PACKET_COUNT without sparse handlers");
+            static_assert(S::TYPE <= (TypeId)~(TypeId)0, "message type must fit TypeId");
+
+            if (S::NATURAL) return Send((Type)S::TYPE, reinterpret_cast<const uint8_t*>(&msg), S::SIZE);
+
+            uint8_t wire[S::SIZE];
+            S::Encode(msg, wire);
+            return Send((Type)S::TYPE, wire, S::SIZE);
+        }
+
+
+        /// @brief Starts a frame of type straight in the outbound buffer, the caller writes its payload in place and
+        /// sends it with Commit, saving the copy Send makes
+        ///
+        /// The flags, channel and critical bit in effect now apply, the payload isn't delta coded. Nothing else may be
+        /// called on the manager until Commit, a frame that is never committed is simply overwritten by the next one
+        /// @return MAX_PAYLOAD_SIZE writable bytes, nullptr if the frame can't be sent now for the reasons Send
+        /// returns WouldBlock
+        inline uint8_t* BeginSend(Type type) {
+            txOpen = OpenFrame((TypeId)type, txFlags, txChannel, Config::MAX_PAYLOAD_SIZE);
+            return txOpen ? txOpen->payload : nullptr;
+        }
+
+
+        /// @brief Checksums the frame from BeginSend and queues or writes it like Send
+        /// @param len Payload bytes written, at most MAX_PAYLOAD_SIZE, fixed length frames have the rest zeroed
+        /// @return WouldBlock if there is no frame from BeginSend, otherwise as Send
+        inline SendStatus Commit(size_t len) {
+            if (!txOpen) return SendStatus::WouldBlock;
+
+            Packet& frame = *txOpen;
+            txOpen = nullptr;
+
+            if (len > Config::MAX_PAYLOAD_SIZE) len = Config::MAX_PAYLOAD_SIZE;
+            frame.SetPayloadLength(len);
+            memset(frame.payload + len, 0, frame.PayloadLength() - len);
+            return CloseFrame(frame);
+        }
+
+
+        /// @brief Sends a buffer of up to MAX_MESSAGE_SIZE bytes as fragments, delivered as one message on the other end
+        ///
+        /// data isn't copied, fragments are built from it as the transport makes room so it must stay valid and
+        /// unchanged until MessagesPending no longer counts it, Update sends whatever didn't fit straight away
+        /// @param type Type the message is delivered as, see MessageCallback
+        /// @return TooLarge if len is over MAX_MESSAGE_SIZE, WouldBlock if MESSAGE_POOL messages are still being sent,
+        /// Sent once every fragment reached the transport, Queued otherwise
+        inline SendStatus SendMessage(Type type, const uint8_t* data, size_t len) {
+            static_assert(Config::MESSAGE_POOL > 0, "messages need MESSAGE_POOL above 0");
+
+            if (len > Config::MAX_MESSAGE_SIZE) return SendStatus::TooLarge;
+            if (!messages.Queue((TypeId)type, txFlags, txChannel, data, len)) return SendStatus::WouldBlock;
+
+            messages.Pump(*this);
+            return MessagesPending() || Pending() ? SendStatus::Queued : SendStatus::Sent;
+        }
+
+
+        /// @brief Sets the callback for messages of type sent with SendMessage, their fragments never reach Callback's handler
+        ///
+        /// Message handlers only cover the flat table, types at or above PACKET_COUNT have no sparse counterpart
+        /// @param handler Called once per complete message, the message data is only valid until it returns
+        /// @return False if type isn't below PACKET_COUNT
+        inline bool MessageCallback(Type type, MessageHandler handler) {
+            static_assert(Config::MESSAGE_POOL > 0, "messages need MESSAGE_POOL above 0");
+
+            long t = (long)type;
+            if (t < 0 || (size_t)t >= Config::PACKET_COUNT) {
+                return false;
+            }
+
+            messages.Callback((TypeId)t, handler);
+            return true;
+        }
+
+
+        /// @brief Number of messages passed to SendMessage that still have fragments to send, or that were sent
+        /// critical and aren't acked yet
+        inline size_t MessagesPending() const { return messages.Pending(); }
+
+
+        /// @brief Writes every queued frame to the transport in one call, keeping whatever it doesn't accept,
+        /// a paced link only writes as much as TX_RATE allows so far
+        /// @return Sent if nothing is left pending, WouldBlock otherwise
+        inline SendStatus Flush() {
+            const size_t budget = pacer.Budget();
+            if (txHead < txQueued && budget) {
+                const size_t len = txQueued - txHead < budget ? txQueued - txHead : budget;
+                const size_t written = transport.write(TxBuffer() + txHead, len);
+                pacer.Spent(written);
+                stats.BytesOut(written);
+                txHead += written;
+                scheduler.Written(txHead);
+            }
+
+            if (txHead >= txQueued) {
+                txHead = 0;
+                txQueued = 0;
+                return SendStatus::Sent;
+            }
 
-            if (len > MAX_PAYLOAD_SIZE) len = MAX_PAYLOAD_SIZE;
-            if (payload) memcpy(txPacket.payload, payload, len);
-            
-            txPacket.checksum = ComputeChecksum(txPacket);
-            transport.write((uint8_t*)&txPacket, sizeof(Packet));
+            return SendStatus::WouldBlock;
         }
 
 
+        /// @brief Number of bytes accepted by Send that haven't been written to the transport yet
+        inline size_t Pending() const { return txQueued - txHead; }
+
+
+        /// @brief Number of coalesced payloads held until the link has room for them, see COALESCE_SLOTS
+        inline size_t Held() const { return latest.Held(); }
+
+
+        /// @brief Number of critical packets sent but not acked yet
+        inline size_t InFlight() const { return reliability.InFlight(); }
+
+
+        /// @brief Copy of the link counters, all zero unless STATS is enabled
+        inline LinkStats Stats() const { return stats.Snapshot(); }
+
+
+        /// @brief Zeroes the link counters, e.g. after reporting them
+        inline void ResetStats() { stats.Reset(); }
+
+
         /// @brief Checks it a user defined flag was set
         /// @tparam flag Flag [0-3] to check
         /// @return The state of the flag
@@ -121,127 +339,639 @@ namespace pckt {
         /// @param v Value [0-1] to set flag to
         template <uint8_t flag> inline void SetFlag(bool v) {
             static_assert(flag < 4, "flag must be [0,3]");
-            if (v) txPacket.flags |= (1u << flag);
-            else txPacket.flags &= ~(1u << flag);
+            if (v) txFlags |= (1u << flag);
+            else txFlags &= ~(1u << flag);
         }
 
         
-        /// @brief Sets the critical bit flag for the txPacket
+        /// @brief Sets the critical bit flag for sent packets
         /// @param v Value to set critical bit
         inline void SetCritical(bool v) { 
-            if (v) txPacket.flags |= 0b10000000;
-            else txPacket.flags &= 0b01111111;
+            if (v) txFlags |= 0b10000000;
+            else txFlags &= 0b01111111;
+        }
+
+
+        /// @brief Sets the channel sent packets are queued on, see Config::TX_CHANNELS
+        /// @param channel Channel [0, TX_CHANNELS), lower is more urgent, critical packets and acks always use 0
+        inline void SetChannel(uint8_t channel) {
+            txChannel = channel < Config::TX_CHANNELS ? channel : Config::TX_CHANNELS-1;
         }
 
 
         private:
         bool reading;
+        bool restamp; // a resync moved the head, receivedAt is set once the update ends
         size_t bytesRead;
+        size_t bytesSummed;
+        typename Checksum::State rxChecksum;
         unsigned long receivedAt;
 
-        Handler handlers[PACKET_COUNT];
-        Transport& transport;
+        Delegate handlers[Config::PACKET_COUNT];
+        SparseHandlers<Config> sparse;
+        TransportType& transport;
+
+        Reliability<Config> reliability;
+        Messages<Config> messages;
+        Delta<Config> delta;
+        LinkCounters<Config> stats;
+
+        static constexpr size_t TX_BURST = Config::TX_BURST > 0 ? Config::TX_BURST : MAX_FRAME_SIZE;
+        Pacer<Config, TX_BURST> pacer;
+        Coalescer<Config> latest;
+
+        // the candidate frame starts rxStart bytes in, a frame of slack behind it lets resync drop bytes off
+        // the front without moving the rest each time, cobs candidates always start at 0
+        static constexpr size_t RX_WINDOW = COBS ? sizeof(Packet) : 2*sizeof(Packet);
+        Buffer<RX_WINDOW> rxWindow;
+        size_t rxStart;
+        bool discarding; // cobs candidate overflowed the rx window, drop bytes up to the next delimiter
+
+        // without a queue the buffer holds the one frame in flight
+        static constexpr size_t TX_CAPACITY = Config::TX_QUEUE_SIZE > 0 ? Config::TX_QUEUE_SIZE : MAX_FRAME_SIZE;
+
+        // fewest bytes a frame can take on the wire, bounds how many frames fit in the tx queue
+        static constexpr size_t MIN_FRAME_SIZE = Packet::HEADER_SIZE + (Config::VARIABLE_LENGTH ? 0 : Config::MAX_PAYLOAD_SIZE) +
+                                                 sizeof(typename Checksum::Type) + (COBS ? 1 : 0);
+
+        Buffer<Config::RX_BATCH_SIZE> rxBatch;
+        Buffer<TX_CAPACITY> txQueue;
+        Scheduler<Config, TX_CAPACITY / MIN_FRAME_SIZE + 1> scheduler; // + the rest of a frame partly written
+
+        uint8_t txFlags;
+        uint8_t txChannel;
+        uint8_t txOpenChannel; // channel of the frame handed out by BeginFrame
+        Packet* txOpen; // frame handed out by BeginSend, until Commit
+        size_t txHead;   // first byte not yet accepted by the transport
+        size_t txQueued; // end of the last committed frame
+        unsigned long txQueuedAt;
+
+
+        inline uint8_t* TxBuffer() { return txQueue.data(); }
+
+        /// @brief Handler for Callback<T, handler>, hands handler the payload as a T
+        template <typename T, void(*handler)(const T&)> struct Typed {
+            static void Call(const Packet& packet) {
+                using S = Schema<T>;
+                if (packet.PayloadLength() < S::SIZE) return;
+
+                // nothing to align, the payload is a T where it lies
+                if (S::NATURAL && alignof(T) == 1) {
+                    handler(*reinterpret_cast<const T*>(packet.payload));
+                    return;
+                }
+
+                T msg;
+                S::Decode(packet.payload, msg);
+                handler(msg);
+            }
+        }; // struct Typed
+
+        /// @brief The candidate frame being received, packed so it can start anywhere in the window
+        inline Packet& RxPacket() { return *reinterpret_cast<Packet*>(rxWindow.data() + rxStart); }
+        inline const Packet& RxPacket() const { return *reinterpret_cast<const Packet*>(rxWindow.data() + rxStart); }
+
+        /// @brief Builds and commits a frame with the given header
+        inline SendStatus SendFrame(TypeId type, uint8_t flags, const uint8_t* payload, size_t len) {
+            if (len > Config::MAX_PAYLOAD_SIZE) len = Config::MAX_PAYLOAD_SIZE;
+
+            Packet* next = OpenFrame(type, flags, txChannel, len);
+            if (!next) return SendStatus::WouldBlock;
+
+            Packet& frame = *next;
+            if (payload) memcpy(frame.payload, payload, len);
+            else memset(frame.payload, 0, len);
+
+            return CloseFrame(frame);
+        }
+
+        /// @brief Builds and commits a keyframe or a delta of the payload, see Delta
+        inline SendStatus SendDelta(TypeId type, const uint8_t* payload, size_t len) {
+            Packet* next = OpenFrame(type, txFlags | Delta<Config>::DELTA_FLAG, txChannel, delta.Plan(type, payload, len));
+            if (!next) return SendStatus::WouldBlock;
+
+            delta.Encode(type, payload, len, next->payload);
+            return CloseFrame(*next);
+        }
+
+        /// @brief Starts a frame with its header filled in, the caller writes payload[0, len) and passes it to CloseFrame
+        /// @param len Payload bytes, at most MAX_PAYLOAD_SIZE
+        /// @return nullptr if the frame can't be sent now
+        inline Packet* OpenFrame(TypeId type, uint8_t flags, uint8_t channel, size_t len) {
+            if (!reliability.CanSend(flags)) return nullptr;
 
-        Packet txPacket;
-        Packet rxPacket;
+            Packet* next = BeginFrame(ChannelOf(type, flags, channel));
+            if (!next) return nullptr;
+
+            Packet& frame = *next;
+            frame.magic = Config::MAGIC_NUM;
+            frame.type = type;
+            frame.flags = flags;
+
+            // with variable lengths only len bytes go on the wire, nothing else to clear
+            frame.SetPayloadLength(len);
+            memset(frame.payload + len, 0, frame.PayloadLength() - len);
+            return next;
+        }
+
+        /// @brief Commits a frame from OpenFrame once its payload is written
+        inline SendStatus CloseFrame(Packet& frame) {
+            reliability.Track(frame);
+            return CommitFrame(frame);
+        }
+
+
+        /// @brief Where the next outbound frame is built, nullptr if the transport hasn't taken enough to make room
+        /// @param channel Channel the frame goes on, the last frame's worth of room is kept for channel 0
+        /// and weighted channels are held to their share of the rest
+        inline Packet* BeginFrame(uint8_t channel = 0) {
+            const size_t room = Config::TX_CHANNELS > 1 && channel ? 2*MAX_FRAME_SIZE : MAX_FRAME_SIZE;
+
+            // a full size frame must fit, write out what is queued and drop what was written if it doesn't
+            if (TX_CAPACITY - txQueued < room) {
+                Flush();
+
+                memmove(TxBuffer(), TxBuffer() + txHead, txQueued - txHead);
+                txQueued -= txHead;
+                scheduler.Shifted(txHead);
+                txHead = 0;
+
+                if (TX_CAPACITY - txQueued < room) {
+                    return nullptr;
+                }
+            }
+
+            if (!scheduler.Admits(channel, MAX_FRAME_SIZE, TX_CAPACITY - MAX_FRAME_SIZE)) {
+                return nullptr;
+            }
+
+            txOpenChannel = channel;
+            return reinterpret_cast<Packet*>(TxBuffer() + txQueued);
+        }
+
+        /// @brief Fills in the checksum of a frame from BeginFrame and queues it, writing it straight away without a queue
+        inline SendStatus CommitFrame(Packet& frame) {
+            const uint8_t channel = txOpenChannel;
+
+            size_t size = frame.FrameSize();
+            const typename Checksum::Type checksum = Checksum::Compute(frame.self(), size - sizeof(checksum));
+            memcpy(frame.self() + size - sizeof(checksum), &checksum, sizeof(checksum));
+
+            // stuffed in place, the magic byte's slot becomes the first code so only the delimiter is added
+            if (COBS) {
+                cobs::Encode(frame.self(), size);
+                frame.self()[size++] = cobs::DELIMITER;
+            }
+
+            if (!Pending()) txQueuedAt = Millis();
+
+            // ahead of queued frames that go after it, the built frame is rotated back into place
+            const size_t at = scheduler.Place(channel, size, txQueued);
+            if (at < txQueued) {
+                Reverse(TxBuffer() + at, txQueued - at);
+                Reverse(TxBuffer() + txQueued, size);
+                Reverse(TxBuffer() + at, txQueued + size - at);
+            }
+
+            txQueued += size;
+            stats.FrameSent();
+
+            // channel 0 doesn't wait for the flush timeout
+            const bool urgent = Config::TX_CHANNELS > 1 && channel == 0;
+            if ((Config::TX_QUEUE_SIZE == 0 || urgent) && Flush() == SendStatus::Sent) {
+                return SendStatus::Sent;
+            }
+
+            return SendStatus::Queued;
+        }
+
+        /// @brief Checks a frame of up to size bytes would be written by the next Flush along with everything queued
+        inline bool CanWriteNow(size_t size) { return Pending() + size <= pacer.Budget(); }
+
+        /// @brief Channel a frame asked to go on is queued on, critical packets and acks keep reliable delivery moving on channel 0
+        inline uint8_t ChannelOf(TypeId type, uint8_t flags, uint8_t channel) const {
+            return (flags & 0b10000000) || type == (TypeId)Type::AckPacket ? 0 : channel;
+        }
+
+        /// @brief Reverses bytes in place, three reversals rotate a frame to the front of the bytes before it
+        static inline void Reverse(uint8_t* data, size_t len) {
+            for (size_t i = 0, j = len; i + 1 < j; i++, j--) {
+                const uint8_t t = data[i];
+                data[i] = data[j-1];
+                data[j-1] = t;
+            }
+        }
 
 
         /// @brief Resets internal state
         inline void ResetState() {
-            rxPacket.magic = 0;
+            rxStart = 0;
             reading = false;
+            restamp = false;
             receivedAt = 0;
             bytesRead = 0;
+            bytesSummed = 0;
+            discarding = false;
+            Checksum::Reset(rxChecksum);
         }
 
 
-        /// @brief Compute the fletcher16 checksum
-        /// @param packet Packet to compute checksum from
-        /// @return Computed checksum
-        static inline uint16_t ComputeChecksum(const Packet& packet) {
-            uint16_t sum1 = 0;
-            uint16_t sum2 = 0;
+        /// @brief Checks a verified frame's type has a handler slot, a dense one or a registered sparse one
+        inline bool KnownType(TypeId type) const {
+            return type < Config::PACKET_COUNT || sparse.Find(type);
+        }
 
-            for (size_t i = 0; i < sizeof(Packet)-sizeof(packet.checksum); i++) {
-                sum1 = (sum1 + ((uint8_t*)&packet)[i]) % 255;
-                sum2 = (sum2 + sum1) % 255;
-            }
+        /// @brief Checks the header describes a frame that fits in a Packet
+        static inline bool HasValidLength(const Packet& packet) {
+            return packet.PayloadLength() <= Config::MAX_PAYLOAD_SIZE;
+        }
 
-            return (sum2 << 8) | sum1;
+        /// @brief Reads the checksum that trails the payload of a complete frame
+        static inline typename Checksum::Type FrameChecksum(const Packet& packet) {
+            typename Checksum::Type checksum;
+            memcpy(&checksum, packet.self() + packet.FrameSize() - sizeof(checksum), sizeof(checksum));
+            return checksum;
+        }
+
+        /// @brief Bytes the rx packet needs before it can be processed further, the header then the rest of the frame
+        inline size_t BytesExpected() const {
+            if (bytesRead < Packet::HEADER_SIZE) return Packet::HEADER_SIZE;
+            return RxPacket().FrameSize();
+        }
+
+
+        /// @brief Feeds any held bytes covered by the checksum into the running checksum, the header must be complete
+        inline void AccumulateChecksum() {
+            const size_t covered = RxPacket().FrameSize() - sizeof(typename Checksum::Type);
+            const size_t end = bytesRead < covered ? bytesRead : covered;
+
+            if (end > bytesSummed) {
+                Checksum::Update(rxChecksum, RxPacket().self()+bytesSummed, end-bytesSummed);
+                bytesSummed = end;
+            }
         }
 
-        /// @brief Updates the rxPacket buffer head to the next magic number
+        /// @brief Drops the failed candidate at the head of the rx window, up to the next magic number in it
         inline void MoveHeadToNextMagic() {
-            // search for magic num in bytes already read
-            for (size_t i = 1; i < bytesRead; i++) {
-                if (rxPacket.self()[i] == MAGIC_NUM) {
-                    memmove(rxPacket.self(), rxPacket.self()+i, bytesRead-i);
-                    bytesRead -= i;
-                    return;
-                }
+            const uint8_t* head = RxPacket().self();
+            const uint8_t* next = bytesRead > 1 ? (const uint8_t*)memchr(head+1, Config::MAGIC_NUM, bytesRead-1) : nullptr;
+            const size_t skip = next ? next - head : bytesRead;
+
+            stats.Skip(skip);
+            DropHead(skip);
+            restamp = bytesRead > 0;
+        }
+
+        /// @brief Removes n bytes from the front of the rx window, what is kept only moves once the slack runs out
+        inline void DropHead(size_t n) {
+            const uint8_t* head = RxPacket().self();
+
+            if (ROLLING && n < bytesSummed) {
+                for (size_t i = 0; i < n; i++) chk::Window<Checksum>::Drop(rxChecksum, head[i], bytesSummed--);
+            } else {
+                Checksum::Reset(rxChecksum);
+                bytesSummed = 0;
             }
 
-            // no magic found, reset, keep buffer to keep looking
-            ResetState();
+            bytesRead -= n;
+            if (!bytesRead) {
+                ResetState();
+                return;
+            }
+
+            // a whole frame must still fit behind the head, kept bytes are moved at most once per frame dropped
+            rxStart += n;
+            if (rxStart > RX_WINDOW - sizeof(Packet)) {
+                memmove(rxWindow.data(), head + n, bytesRead);
+                rxStart = 0;
+            }
+        }
+
+
+        /// @brief Decodes a chunk of received bytes with the configured framing
+        inline void Decode(const uint8_t* data, size_t len) {
+            if (COBS) DecodeCobs(data, len);
+            else DecodeBatch(data, len);
         }
 
 
         /// @brief Attempts to read packet from transport buffer
         inline void TryReadPacket() {
+            if (COBS) {
+                if (bytesRead == sizeof(Packet)) {
+                    uint8_t next;
+                    if (transport.read(&next, 1) <= 0) return;
+
+                    stats.BytesIn(1);
+                    FinishFullCandidate(next);
+                    return;
+                }
+
+                // the end of a cobs frame is only known once its delimiter arrives, read whatever fits
+                const size_t from = bytesRead;
+                int recv = transport.read(rxWindow.data()+bytesRead, sizeof(Packet)-bytesRead);
+                if (recv <= 0) return;
+
+                stats.BytesIn(recv);
+                bytesRead += recv;
+                ScanCobs(from);
+                return;
+            }
+
             // if first byte read, set state
             if (!reading) {
                 bytesRead = 0;
                 reading = true;
-                receivedAt = millis();
+                receivedAt = Millis();
             }
 
-            size_t remaining = sizeof(Packet) - bytesRead;
-            int recv = transport.read(rxPacket.self()+bytesRead, remaining);
+            // never read past the frame, the header says how long it is
+            size_t remaining = BytesExpected() - bytesRead;
+            int recv = transport.read(RxPacket().self()+bytesRead, remaining);
             if (recv <= 0) return;
 
-            // read enough for magic num, verify it, before we continue
+            stats.BytesIn(recv);
+
             bytesRead += recv;
-            if (bytesRead >= sizeof(rxPacket.magic)) {
-                if (rxPacket.magic != MAGIC_NUM) {
+            ProcessRxPacket();
+        }
+
+
+        /// @brief Verifies and dispatches the candidates held in the rx window, keeping an incomplete one for more bytes
+        ///
+        /// Every byte is dropped off the front at most once and a rolling checksum takes it back out of the running
+        /// sum in constant time, so resyncing through any input costs time linear in the bytes received
+        inline void ProcessRxPacket() {
+            while (bytesRead) {
+                const Packet& packet = RxPacket();
+
+                // verify the magic num before we continue
+                if (packet.magic != Config::MAGIC_NUM) {
                     MoveHeadToNextMagic();
+                    continue;
+                }
+
+                // not enough for the header, wait for more
+                if (bytesRead < Packet::HEADER_SIZE) return;
+
+                // length byte out of range, can't be a real frame
+                if (!HasValidLength(packet)) {
+                    stats.Resync();
+                    MoveHeadToNextMagic();
+                    continue;
+                }
+
+                // not enough for a full packet, wait for more
+                AccumulateChecksum();
+                const size_t size = packet.FrameSize();
+                if (bytesRead < size) return;
+
+                // verify checksum, already accumulated as bytes arrived
+                if (FrameChecksum(packet) != Checksum::Final(rxChecksum)) {
+                    stats.ChecksumFailure();
+                    stats.Resync();
+                    MoveHeadToNextMagic();
+                    continue;
+                }
+
+                // malformed, type of out range, move to next magic keeping what is after it
+                if (!KnownType(packet.type)) {
+                    stats.BadType();
+                    stats.Resync();
+                    MoveHeadToNextMagic();
+                    continue;
+                }
+
+                // packet has been verified, call user defined handler
+                Dispatch(packet);
+
+                // with variable lengths a resync can leave whole frames behind it
+                DropHead(size);
+            }
+        }
+
+
+        /// @brief Decodes every complete frame in a chunk in place, only a trailing partial frame is copied
+        /// @param data Chunk of received bytes, must stay valid until this returns
+        /// @param len Number of bytes in the chunk
+        inline void DecodeBatch(const uint8_t* data, size_t len) {
+            // finish the frame carried over from the previous chunk
+            while (bytesRead && len) {
+                size_t take = BytesExpected() - bytesRead;
+                if (take > len) take = len;
+
+                memcpy(RxPacket().self()+bytesRead, data, take);
+                bytesRead += take;
+                data += take;
+                len -= take;
+
+                ProcessRxPacket();
+            }
+
+            // sum of the last candidate checked and where it starts, see CandidateChecksum
+            typename Checksum::State sum;
+            Checksum::Reset(sum);
+            const uint8_t* summedAt = nullptr;
+
+            while (len) {
+                const uint8_t* head = (const uint8_t*)memchr(data, Config::MAGIC_NUM, len);
+                if (!head) {
+                    stats.Skip(len);
                     return;
                 }
+
+                stats.Skip(head - data);
+                len -= head - data;
+                data = head;
+
+                // packed, so a frame can be viewed in place at any alignment
+                const Packet& frame = *reinterpret_cast<const Packet*>(data);
+                if (len >= Packet::HEADER_SIZE && !HasValidLength(frame)) {
+                    stats.Resync();
+                    stats.Skip(1);
+                    data++;
+                    len--;
+                    continue;
+                }
+
+                // trailing partial frame, carry it to the next chunk
+                if (len < Packet::HEADER_SIZE || len < frame.FrameSize()) {
+                    memcpy(rxWindow.data(), data, len);
+                    rxStart = 0;
+                    reading = true;
+                    receivedAt = Millis();
+                    bytesRead = len;
+                    return;
+                }
+
+                const size_t size = frame.FrameSize();
+                const bool intact = FrameChecksum(frame) == CandidateChecksum(data, size - sizeof(typename Checksum::Type), sum, summedAt);
+                if (intact && KnownType(frame.type)) {
+                    Dispatch(frame);
+                    data += size;
+                    len -= size;
+                } else {
+                    // false or corrupt magic, search again from the next byte
+                    if (intact) stats.BadType();
+                    else stats.ChecksumFailure();
+                    stats.Resync();
+                    stats.Skip(1);
+                    data++;
+                    len--;
+                }
             }
+        }
 
-            // not enough for a full packet, wait for more
-            if (bytesRead != sizeof(Packet)) {
-                return;
+        /// @brief Checksum over the first covered bytes of the candidate at data
+        ///
+        /// With a rolling policy the previous candidate's sum slides forward when it starts fewer than covered bytes
+        /// back, so no byte is summed more than twice however many candidates overlap it
+        inline typename Checksum::Type CandidateChecksum(const uint8_t* data, size_t covered, typename Checksum::State& sum, const uint8_t*& summedAt) {
+            if (!ROLLING) return Checksum::Compute(data, covered);
+
+            if (summedAt && (size_t)(data - summedAt) < covered) {
+                for (; summedAt < data; summedAt++) {
+                    chk::Window<Checksum>::Drop(sum, *summedAt, covered);
+                    Checksum::Update(sum, summedAt[covered]);
+                }
+
+                return Checksum::Final(sum);
             }
 
-            // verify checksum
-            if (rxPacket.checksum != ComputeChecksum(rxPacket)) {
-                MoveHeadToNextMagic();
-                return;
+            typename Checksum::State fresh;
+            Checksum::Reset(fresh);
+            Checksum::Update(fresh, data, covered);
+
+            sum = fresh;
+            summedAt = data;
+            return Checksum::Final(fresh);
+        }
+
+
+        /// @brief Copies a chunk into the rx window as it fits, every delimiter in it ends a candidate frame
+        inline void DecodeCobs(const uint8_t* data, size_t len) {
+            while (len) {
+                if (bytesRead == sizeof(Packet)) {
+                    FinishFullCandidate(*data++);
+                    len--;
+                    continue;
+                }
+
+                size_t take = sizeof(Packet) - bytesRead;
+                if (take > len) take = len;
+
+                const size_t from = bytesRead;
+                memcpy(rxWindow.data()+bytesRead, data, take);
+                bytesRead += take;
+                data += take;
+                len -= take;
+
+                ScanCobs(from);
+            }
+        }
+
+        /// @brief Finishes every candidate in the rx window whose delimiter has arrived, keeping the bytes after the last one
+        /// @param from First byte not scanned for a delimiter yet
+        inline void ScanCobs(size_t from) {
+            uint8_t* buffer = rxWindow.data();
+
+            while (const uint8_t* end = (const uint8_t*)memchr(buffer+from, cobs::DELIMITER, bytesRead-from)) {
+                const size_t size = end - buffer;
+                const size_t rest = bytesRead - size - 1;
+
+                if (discarding) {
+                    stats.Skip(size + 1);
+                    discarding = false;
+                } else {
+                    ProcessCobsFrame(size);
+                }
+
+                // the next candidate starts right after the delimiter
+                memmove(buffer, end+1, rest);
+                bytesRead = rest;
+                reading = false;
+                from = 0;
             }
 
-            // packet has been verified, call user defined handler
-            const uint8_t t = rxPacket.type;
-            if (t < PACKET_COUNT) {
-                if (handlers[rxPacket.type]) handlers[rxPacket.type](rxPacket);
+            if (bytesRead && !reading) {
+                reading = true;
+                receivedAt = Millis();
+            }
+        }
+
+        /// @brief The rx window is full, the candidate is only a frame if the byte after it is its delimiter
+        inline void FinishFullCandidate(uint8_t next) {
+            if (next == cobs::DELIMITER && !discarding) {
+                ProcessCobsFrame(sizeof(Packet));
             } else {
-                // malformed, type of out range, move to next magic
-                MoveHeadToNextMagic();
+                // too long to be a frame, drop everything up to the next delimiter
+                if (!discarding) stats.Resync();
+                stats.Skip(sizeof(Packet) + 1);
+                discarding = next != cobs::DELIMITER;
             }
 
-            // reset state for next packet
-            ResetState();
+            bytesRead = 0;
+            reading = false;
         }
 
+        /// @brief Unstuffs, verifies and dispatches the candidate frame held in the rx window [0, size)
+        inline void ProcessCobsFrame(size_t size) {
+            // back to back delimiters, nothing lost
+            if (!size) {
+                stats.Skip(1);
+                return;
+            }
+
+            Packet& packet = RxPacket();
+            bool valid = cobs::Decode(packet.self(), size);
+            packet.magic = Config::MAGIC_NUM;
 
-        static inline bool HasCritical(const Packet& packet) { return packet.flags & 0b10000000; }
+            valid = valid && size >= Packet::HEADER_SIZE && HasValidLength(packet) && size == packet.FrameSize();
+            if (valid && FrameChecksum(packet) != Checksum::Compute(packet.self(), size - sizeof(typename Checksum::Type))) {
+                stats.ChecksumFailure();
+                valid = false;
+            }
+
+            if (valid && !KnownType(packet.type)) {
+                stats.BadType();
+                valid = false;
+            }
+
+            if (!valid) {
+                stats.Resync();
+                stats.Skip(size + 1);
+                return;
+            }
+
+            Dispatch(packet);
+        }
+
+
+        /// @brief Hands a verified packet to its handler, critical packets first go through reliable delivery,
+        /// fragments are reassembled instead and delta coded payloads are rebuilt
+        inline void Dispatch(const Packet& packet) {
+            if (!reliability.Accept(*this, packet)) return;
+            stats.FrameDelivered();
+            if (messages.Accept(*this, packet)) return;
+
+            const Packet* decoded = delta.Decode(packet);
+            if (!decoded) return;
+
+            if (packet.type < Config::PACKET_COUNT) {
+                if (handlers[packet.type]) handlers[packet.type](*decoded);
+            } else if (const Delegate* handler = sparse.Find(packet.type)) {
+                (*handler)(*decoded);
+            }
+        }
     }; // struct PacketManager
 
 
 } // namespace pckt
 
+#if defined(ARDUINO)
 namespace trns {
 
-    struct SerialTransport : public pckt::Transport {
+    struct SerialTransport final : public pckt::Transport {
         public:
         SerialTransport(SoftwareSerial& serial) : serial(serial) {}
 
@@ -254,3 +984,4 @@ namespace trns {
     }; // struct SerialTransport
 
 } // namespace trns
+#endif
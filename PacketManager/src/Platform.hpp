@@ -0,0 +1,41 @@
+#pragma once
+#if defined(ARDUINO)
+#include <Arduino.h>
+#include <SoftwareSerial.h>
+#else
+#include <stdint.h>
+#include <stddef.h>
+#include <string.h>
+#include <chrono>
+#endif
+
+namespace pckt {
+
+    /// @brief Byte order of the host, multi byte values always go on the wire little endian
+    #if defined(__BYTE_ORDER__) && __BYTE_ORDER__ == __ORDER_BIG_ENDIAN__
+    static constexpr bool LITTLE_ENDIAN_HOST = false;
+    #else
+    static constexpr bool LITTLE_ENDIAN_HOST = true;
+    #endif
+
+    /// @brief Milliseconds since an arbitrary point, millis() on Arduino and a steady clock elsewhere
+    inline unsigned long Millis() {
+    #if defined(ARDUINO)
+        return millis();
+    #else
+        return (unsigned long)std::chrono::duration_cast<std::chrono::milliseconds>(
+            std::chrono::steady_clock::now().time_since_epoch()).count();
+    #endif
+    }
+
+    /// @brief Microseconds since an arbitrary point, micros() on Arduino and a steady clock elsewhere
+    inline unsigned long Micros() {
+    #if defined(ARDUINO)
+        return micros();
+    #else
+        return (unsigned long)std::chrono::duration_cast<std::chrono::microseconds>(
+            std::chrono::steady_clock::now().time_since_epoch()).count();
+    #endif
+    }
+
+} // namespace pckt
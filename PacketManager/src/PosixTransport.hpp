@@ -0,0 +1,353 @@
+#pragma once
+#include "Transport.hpp"
+
+#if defined(__linux__)
+#include <stdio.h>
+#include <string.h>
+#include <errno.h>
+#include <fcntl.h>
+#include <unistd.h>
+#include <termios.h>
+#include <netdb.h>
+#include <netinet/in.h>
+#include <netinet/tcp.h>
+#include <sys/socket.h>
+#include <sys/un.h>
+
+namespace trns {
+
+    /// @brief Non-blocking transport over any file descriptor, a serial port, pty, socket or pipe
+    ///
+    /// available() reads whatever the fd has into a buffer of N bytes, one read per call, and the manager decodes
+    /// straight out of it through peek. It returns false once the fd would block so an Update drains the fd and
+    /// returns, see EventLoop to only update when there is something to read. Datagram sockets read one datagram
+    /// per call, each must fit N bytes
+    /// @tparam N Size of the receive buffer in bytes
+    template <size_t N = 2048> struct FdTransport final : public pckt::Transport {
+        public:
+        /// @param fd Descriptor to read and write, made non-blocking
+        /// @param owns Close fd along with the transport
+        FdTransport(int fd, bool owns = true) : fd(fd), owns(owns), head(0), tail(0), closed(fd < 0), error(0) {
+            int type = 0;
+            socklen_t len = sizeof(type);
+            socket = fd >= 0 && getsockopt(fd, SOL_SOCKET, SO_TYPE, &type, &len) == 0;
+            datagram = socket && type != SOCK_STREAM;
+            tty = fd >= 0 && isatty(fd);
+
+            if (fd >= 0) fcntl(fd, F_SETFL, fcntl(fd, F_GETFL) | O_NONBLOCK);
+        }
+
+        ~FdTransport() {
+            if (owns && fd >= 0) ::close(fd);
+        }
+
+        FdTransport(const FdTransport&) = delete;
+        FdTransport& operator=(const FdTransport&) = delete;
+
+
+        int read(uint8_t* data, size_t len) override {
+            if (head == tail && !Fill()) return 0;
+
+            const size_t n = tail - head < len ? tail - head : len;
+            memcpy(data, rx + head, n);
+            head += n;
+            return (int)n;
+        }
+
+        size_t write(const uint8_t* data, size_t len) override {
+            if (closed) return 0;
+
+            for (;;) {
+                // a socket whose peer is gone fails the write instead of raising SIGPIPE
+                const ssize_t n = socket ? ::send(fd, data, len, MSG_NOSIGNAL) : ::write(fd, data, len);
+                if (n >= 0) return (size_t)n;
+                if (errno == EINTR) continue;
+                if (errno != EAGAIN && errno != EWOULDBLOCK && errno != ENOBUFS) Fail(errno);
+                return 0;
+            }
+        }
+
+        bool available() override { return head < tail || Fill(); }
+
+        size_t peek(const uint8_t*& data) override {
+            data = rx + head;
+            return tail - head;
+        }
+
+        void consume(size_t len) override { head += len; }
+
+
+        inline int Fd() const { return fd; }
+
+        /// @brief The peer hung up or the fd failed, nothing more will be read or written
+        inline bool Closed() const { return closed; }
+
+        /// @brief errno of the failure that closed the transport, 0 if the peer hung up
+        inline int Error() const { return error; }
+
+
+        private:
+        int fd;
+        bool owns;
+        bool socket;
+        bool datagram;
+        bool tty;
+
+        uint8_t rx[N];
+        size_t head;
+        size_t tail;
+
+        bool closed;
+        int error;
+
+        /// @brief Reads once into the emptied buffer
+        /// @return False if the fd had nothing
+        inline bool Fill() {
+            head = 0;
+            tail = 0;
+            if (closed) return false;
+
+            for (;;) {
+                const ssize_t n = ::read(fd, rx, N);
+                if (n > 0) {
+                    tail = (size_t)n;
+                    return true;
+                }
+
+                // an empty datagram is just that, and a tty reads nothing when VMIN is 0, any other empty read
+                // is the peer hanging up
+                if (n == 0) {
+                    if (!datagram && !tty) closed = true;
+                    return false;
+                }
+
+                if (errno == EINTR) continue;
+
+                // a pty whose other side closed reads EIO
+                if (errno == EIO) closed = true;
+                else if (errno != EAGAIN && errno != EWOULDBLOCK) Fail(errno);
+                return false;
+            }
+        }
+
+        inline void Fail(int err) {
+            closed = true;
+            error = err;
+        }
+    }; // struct FdTransport
+
+
+    /// @brief Opens descriptors for FdTransport, each returns -1 with errno set on failure
+    namespace posix {
+
+        /// @brief Puts a tty in raw mode, 8N1 without flow control or any byte translation
+        /// @param baud Bits per second, one of the standard rates, 0 leaves the rate unchanged (e.g. for a pty)
+        /// @return False if the rate isn't a standard one or the tty refused the settings
+        inline bool MakeRaw(int fd, unsigned long baud) {
+            termios tty;
+            if (tcgetattr(fd, &tty) != 0) return false;
+
+            cfmakeraw(&tty);
+            tty.c_cflag |= CLOCAL | CREAD;
+            tty.c_cflag &= ~(CSTOPB | CRTSCTS);
+
+            // a non-blocking read of nothing fails with EAGAIN instead of returning 0
+            tty.c_cc[VMIN] = 1;
+            tty.c_cc[VTIME] = 0;
+
+            if (baud) {
+                speed_t speed;
+                switch (baud) {
+                    case 9600: speed = B9600; break;
+                    case 19200: speed = B19200; break;
+                    case 38400: speed = B38400; break;
+                    case 57600: speed = B57600; break;
+                    case 115200: speed = B115200; break;
+                    case 230400: speed = B230400; break;
+                #if defined(B460800)
+                    case 460800: speed = B460800; break;
+                    case 921600: speed = B921600; break;
+                #endif
+                    default: errno = EINVAL; return false;
+                }
+
+                cfsetispeed(&tty, speed);
+                cfsetospeed(&tty, speed);
+            }
+
+            return tcsetattr(fd, TCSANOW, &tty) == 0;
+        }
+
+        /// @brief Opens a serial port, e.g. /dev/ttyUSB0, in raw mode
+        inline int Serial(const char* path, unsigned long baud) {
+            const int fd = ::open(path, O_RDWR | O_NOCTTY | O_NONBLOCK | O_CLOEXEC);
+            if (fd < 0) return -1;
+
+            if (!MakeRaw(fd, baud)) {
+                const int err = errno;
+                ::close(fd);
+                errno = err;
+                return -1;
+            }
+
+            return fd;
+        }
+
+        /// @brief Resolves host, connects and binds a socket of type to the first address that takes it
+        /// @param local Bind to port on any address before connecting, 0 leaves it to the kernel
+        /// @param listen Bind to host:port and listen instead of connecting, host may be nullptr for any address
+        inline int Inet(int type, const char* host, uint16_t port, uint16_t local, bool listen) {
+            addrinfo hints;
+            memset(&hints, 0, sizeof(hints));
+            hints.ai_family = AF_UNSPEC;
+            hints.ai_socktype = type;
+            hints.ai_flags = listen ? AI_PASSIVE : 0;
+
+            char service[6];
+            snprintf(service, sizeof(service), "%u", (unsigned)port);
+
+            addrinfo* found;
+            if (getaddrinfo(host, service, &hints, &found) != 0) {
+                errno = EHOSTUNREACH;
+                return -1;
+            }
+
+            int fd = -1;
+            for (addrinfo* a = found; a; a = a->ai_next) {
+                fd = ::socket(a->ai_family, a->ai_socktype | SOCK_CLOEXEC, a->ai_protocol);
+                if (fd < 0) continue;
+
+                const int on = 1;
+                bool ok;
+                if (listen) {
+                    setsockopt(fd, SOL_SOCKET, SO_REUSEADDR, &on, sizeof(on));
+                    ok = bind(fd, a->ai_addr, a->ai_addrlen) == 0 && (type != SOCK_STREAM || ::listen(fd, 16) == 0);
+                } else {
+                    ok = true;
+                    if (local) {
+                        sockaddr_storage any;
+                        memset(&any, 0, sizeof(any));
+                        any.ss_family = (sa_family_t)a->ai_family;
+                        if (a->ai_family == AF_INET6) reinterpret_cast<sockaddr_in6&>(any).sin6_port = htons(local);
+                        else reinterpret_cast<sockaddr_in&>(any).sin_port = htons(local);
+
+                        setsockopt(fd, SOL_SOCKET, SO_REUSEADDR, &on, sizeof(on));
+                        ok = bind(fd, reinterpret_cast<sockaddr*>(&any), a->ai_addrlen) == 0;
+                    }
+
+                    ok = ok && connect(fd, a->ai_addr, a->ai_addrlen) == 0;
+                }
+
+                if (ok) break;
+
+                const int err = errno;
+                ::close(fd);
+                errno = err;
+                fd = -1;
+            }
+
+            freeaddrinfo(found);
+            return fd;
+        }
+
+        /// @brief UDP socket bound to localPort sending to and receiving only from host:port
+        inline int Udp(uint16_t localPort, const char* host, uint16_t port) { return Inet(SOCK_DGRAM, host, port, localPort, false); }
+
+        /// @brief Connects to a TCP server, with Nagle off so frames go out as soon as they are written
+        inline int TcpConnect(const char* host, uint16_t port) {
+            const int fd = Inet(SOCK_STREAM, host, port, 0, false);
+            const int on = 1;
+            if (fd >= 0) setsockopt(fd, IPPROTO_TCP, TCP_NODELAY, &on, sizeof(on));
+            return fd;
+        }
+
+        /// @brief Listens for TCP connections on port, host may be nullptr for any address, see Accept
+        inline int TcpListen(const char* host, uint16_t port) { return Inet(SOCK_STREAM, host, port, 0, true); }
+
+        /// @brief Fills a Unix socket address
+        /// @return False if path doesn't fit
+        inline bool UnixAddress(const char* path, sockaddr_un& addr) {
+            memset(&addr, 0, sizeof(addr));
+            addr.sun_family = AF_UNIX;
+            if (strlen(path) >= sizeof(addr.sun_path)) {
+                errno = ENAMETOOLONG;
+                return false;
+            }
+
+            strcpy(addr.sun_path, path);
+            return true;
+        }
+
+        /// @brief Connects a Unix stream socket to path
+        inline int UnixConnect(const char* path) {
+            sockaddr_un addr;
+            if (!UnixAddress(path, addr)) return -1;
+
+            const int fd = ::socket(AF_UNIX, SOCK_STREAM | SOCK_CLOEXEC, 0);
+            if (fd < 0) return -1;
+
+            if (connect(fd, reinterpret_cast<sockaddr*>(&addr), sizeof(addr)) != 0) {
+                const int err = errno;
+                ::close(fd);
+                errno = err;
+                return -1;
+            }
+
+            return fd;
+        }
+
+        /// @brief Listens for Unix stream connections on path, replacing a stale socket file, see Accept
+        inline int UnixListen(const char* path) {
+            sockaddr_un addr;
+            if (!UnixAddress(path, addr)) return -1;
+
+            const int fd = ::socket(AF_UNIX, SOCK_STREAM | SOCK_CLOEXEC, 0);
+            if (fd < 0) return -1;
+
+            unlink(path);
+            if (bind(fd, reinterpret_cast<sockaddr*>(&addr), sizeof(addr)) != 0 || ::listen(fd, 16) != 0) {
+                const int err = errno;
+                ::close(fd);
+                errno = err;
+                return -1;
+            }
+
+            return fd;
+        }
+
+        /// @brief Unix datagram socket bound to path sending to and receiving only from peer, replacing a stale socket file
+        inline int UnixDatagram(const char* path, const char* peer) {
+            sockaddr_un local, remote;
+            if (!UnixAddress(path, local) || !UnixAddress(peer, remote)) return -1;
+
+            const int fd = ::socket(AF_UNIX, SOCK_DGRAM | SOCK_CLOEXEC, 0);
+            if (fd < 0) return -1;
+
+            unlink(path);
+            if (bind(fd, reinterpret_cast<sockaddr*>(&local), sizeof(local)) != 0 ||
+                connect(fd, reinterpret_cast<sockaddr*>(&remote), sizeof(remote)) != 0) {
+                const int err = errno;
+                ::close(fd);
+                errno = err;
+                return -1;
+            }
+
+            return fd;
+        }
+
+        /// @brief Accepts a pending connection on a TCP or Unix listener
+        /// @return -1 with errno EAGAIN if none is pending on a non-blocking listener
+        inline int Accept(int listener) {
+            const int fd = ::accept(listener, nullptr, nullptr);
+            if (fd < 0) return -1;
+
+            fcntl(fd, F_SETFD, FD_CLOEXEC);
+            const int on = 1;
+            setsockopt(fd, IPPROTO_TCP, TCP_NODELAY, &on, sizeof(on));
+            return fd;
+        }
+
+    } // namespace posix
+
+} // namespace trns
+#endif
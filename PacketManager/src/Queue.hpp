@@ -0,0 +1,134 @@
+#pragma once
+#include "Platform.hpp"
+
+#if defined(__linux__)
+
+namespace trns {
+
+    /// @brief Bounded single producer / single consumer queue of T, the element counterpart of RingBufferTransport
+    ///
+    /// Each side keeps a copy of the other's index and only reloads it when the queue looks full or empty, so
+    /// the cache line the other side writes is only touched once per batch
+    /// @tparam N Size of the ring, must be a power of two, holds up to N-1 elements
+    template <typename T, size_t N> struct SpscQueue {
+        static_assert(N >= 2 && (N & (N-1)) == 0, "queue size must be a power of two");
+
+        public:
+        SpscQueue() : head(0), tailCache(0), tail(0), headCache(0) {}
+
+        /// @brief Producer side, slot the next element is written to before Push, nullptr if the queue is full
+        inline T* Claim() {
+            const size_t next = (head + 1) & MASK;
+            if (next == tailCache) {
+                tailCache = __atomic_load_n(&tail, __ATOMIC_ACQUIRE);
+                if (next == tailCache) return nullptr;
+            }
+
+            return &slots[head];
+        }
+
+        /// @brief Producer side, publishes the slot from Claim
+        inline void Push() { __atomic_store_n(&head, (head + 1) & MASK, __ATOMIC_RELEASE); }
+
+        /// @brief Consumer side, the oldest element, nullptr if the queue is empty
+        inline T* Front() {
+            if (tail == headCache) {
+                headCache = __atomic_load_n(&head, __ATOMIC_ACQUIRE);
+                if (tail == headCache) return nullptr;
+            }
+
+            return &slots[tail];
+        }
+
+        /// @brief Consumer side, releases the element from Front
+        inline void Pop() { __atomic_store_n(&tail, (tail + 1) & MASK, __ATOMIC_RELEASE); }
+
+
+        private:
+        static constexpr size_t MASK = N - 1;
+
+        // producer and consumer indices a cache line apart, padded rather than aligned as C++11 new ignores alignas
+        size_t head;
+        size_t tailCache;
+        uint8_t producerPad[64];
+        size_t tail;
+        size_t headCache;
+        uint8_t consumerPad[64];
+        T slots[N];
+    }; // struct SpscQueue
+
+
+    /// @brief Bounded multi producer / single consumer queue of T, producers never wait on each other or take a lock
+    ///
+    /// Every slot carries a sequence number saying whose turn it is: a producer claims the next slot by moving
+    /// the shared tail on with one compare and swap, fills it in place and publishes it by bumping its sequence,
+    /// so producers only contend on the tail and copy their elements in parallel. The consumer reads slots in
+    /// claim order, a slot claimed but not yet published holds back the ones claimed after it
+    /// @tparam N Size of the ring, must be a power of two, holds up to N elements
+    template <typename T, size_t N> struct MpscQueue {
+        static_assert(N >= 2 && (N & (N-1)) == 0, "queue size must be a power of two");
+
+        public:
+        MpscQueue() : tail(0), head(0) {
+            for (size_t i = 0; i < N; i++) cells[i].sequence = i;
+        }
+
+        /// @brief Producer side, from any thread, slot the next element is written to before Push, nullptr if the
+        /// queue is full
+        /// @param ticket Set to the claim Push publishes
+        inline T* Claim(size_t& ticket) {
+            size_t pos = __atomic_load_n(&tail, __ATOMIC_RELAXED);
+            for (;;) {
+                Cell& cell = cells[pos & MASK];
+                const size_t sequence = __atomic_load_n(&cell.sequence, __ATOMIC_ACQUIRE);
+                const intptr_t lag = (intptr_t)(sequence - pos);
+
+                if (lag == 0) {
+                    // a failed swap reloads pos with the tail another producer moved on
+                    if (__atomic_compare_exchange_n(&tail, &pos, pos + 1, true, __ATOMIC_RELAXED, __ATOMIC_RELAXED)) {
+                        ticket = pos;
+                        return &cell.value;
+                    }
+                } else if (lag < 0) {
+                    // the consumer hasn't released the slot since the last lap
+                    return nullptr;
+                } else {
+                    pos = __atomic_load_n(&tail, __ATOMIC_RELAXED);
+                }
+            }
+        }
+
+        /// @brief Producer side, publishes the slot claimed with ticket
+        inline void Push(size_t ticket) { __atomic_store_n(&cells[ticket & MASK].sequence, ticket + 1, __ATOMIC_RELEASE); }
+
+        /// @brief Consumer side, the oldest element, nullptr if the queue is empty or it isn't published yet
+        inline T* Front() {
+            Cell& cell = cells[head & MASK];
+            return __atomic_load_n(&cell.sequence, __ATOMIC_ACQUIRE) == head + 1 ? &cell.value : nullptr;
+        }
+
+        /// @brief Consumer side, releases the element from Front for the claim a lap later
+        inline void Pop() {
+            __atomic_store_n(&cells[head & MASK].sequence, head + N, __ATOMIC_RELEASE);
+            head++;
+        }
+
+
+        private:
+        static constexpr size_t MASK = N - 1;
+
+        struct Cell {
+            size_t sequence; // claim it waits for, claim + 1 once published
+            T value;
+        }; // struct Cell
+
+        // the tail producers swap on and the consumer's head a cache line apart
+        size_t tail;
+        uint8_t producerPad[64];
+        size_t head;
+        uint8_t consumerPad[64];
+        Cell cells[N];
+    }; // struct MpscQueue
+
+} // namespace trns
+#endif
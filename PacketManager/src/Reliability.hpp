@@ -0,0 +1,228 @@
+#pragma once
+#include "Platform.hpp"
+#include "Packet.hpp"
+
+namespace pckt {
+
+    /// @brief Sliding window reliable delivery for critical packets, compiled away when RELIABLE_WINDOW is 0
+    ///
+    /// The manager it is driven by must expose BeginFrame, CommitFrame and SendFrame to it
+    template <typename Config, bool Enabled = (Config::RELIABLE_WINDOW > 0)>
+    struct Reliability {
+        using Packet = pckt::Packet<Config>;
+
+        public:
+        /// @brief Checks a frame with these flags may be sent now
+        inline bool CanSend(uint8_t flags) const { (void)flags; return true; }
+
+        /// @brief Numbers a frame and keeps a copy of it if critical, called once its payload is filled in
+        inline void Track(Packet& frame) { (void)frame; }
+
+        /// @brief Runs a verified packet through reliable delivery
+        /// @return False if the packet is a duplicate and must not reach its handler
+        template <typename Manager> inline bool Accept(Manager& manager, const Packet& packet) {
+            (void)manager; (void)packet;
+            return true;
+        }
+
+        /// @brief Resends whatever timed out
+        template <typename Manager> inline void Retransmit(Manager& manager) { (void)manager; }
+
+        /// @brief Number of critical packets sent but not acked yet
+        inline size_t InFlight() const { return 0; }
+
+        /// @brief Sequence number the next critical packet gets
+        inline uint8_t NextSequence() const { return 0; }
+
+        /// @brief Checks every critical packet up to and including seq has been acked
+        inline bool Acked(uint8_t seq) const { (void)seq; return true; }
+    }; // struct Reliability
+
+
+    template <typename Config> struct Reliability<Config, true> {
+        using Packet = pckt::Packet<Config>;
+
+        static_assert(Config::RELIABLE_WINDOW <= 32 && (Config::RELIABLE_WINDOW & (Config::RELIABLE_WINDOW-1)) == 0, "reliable window must be a power of two up to 32");
+        static_assert(Config::MAX_PAYLOAD_SIZE >= 5, "acks need 5 payload bytes");
+
+        public:
+        Reliability() {
+            sndBase = 0;
+            sndNext = 0;
+            rcvNext = 0;
+            rcvMask = 0;
+            srtt = 0;
+            rttvar = 0;
+            rto = Config::RELIABLE_INITIAL_RTO;
+        }
+
+        inline bool CanSend(uint8_t flags) const {
+            return !HasCritical(flags) || InFlight() < Config::RELIABLE_WINDOW;
+        }
+
+        inline void Track(Packet& frame) {
+            if (!HasCritical(frame.flags)) {
+                frame.seq = 0;
+                return;
+            }
+
+            // keep a copy to retransmit until it is acked
+            frame.seq = sndNext;
+            WindowSlot& slot = window[sndNext & (Config::RELIABLE_WINDOW-1)];
+            memcpy(&slot.frame, &frame, frame.FrameSize());
+            slot.sentAt = Millis();
+            slot.acked = false;
+            slot.retransmitted = false;
+            sndNext++;
+        }
+
+        template <typename Manager> inline bool Accept(Manager& manager, const Packet& packet) {
+            if (packet.type == (typename Config::TypeId)Type::AckPacket) {
+                ProcessAck(packet);
+                return true;
+            }
+
+            return !HasCritical(packet.flags) || AcceptCritical(manager, packet.seq);
+        }
+
+        /// @brief Resends every unacked critical packet older than the timeout, backing the timeout off
+        template <typename Manager> inline void Retransmit(Manager& manager) {
+            const unsigned long now = Millis();
+            bool resent = false;
+
+            for (uint8_t seq = sndBase; seq != sndNext; seq++) {
+                WindowSlot& slot = window[seq & (Config::RELIABLE_WINDOW-1)];
+                if (slot.acked || (now - slot.sentAt) < rto) continue;
+
+                Packet* next = manager.BeginFrame();
+                if (!next) break;
+
+                memcpy(next, &slot.frame, slot.frame.FrameSize());
+                manager.CommitFrame(*next);
+                slot.sentAt = now;
+                slot.retransmitted = true;
+                resent = true;
+            }
+
+            if (resent) {
+                rto = rto*2 < Config::RELIABLE_MAX_RTO ? rto*2 : Config::RELIABLE_MAX_RTO;
+            }
+        }
+
+        inline size_t InFlight() const { return (uint8_t)(sndNext - sndBase); }
+
+        inline uint8_t NextSequence() const { return sndNext; }
+
+        inline bool Acked(uint8_t seq) const { return (uint8_t)(seq - sndBase) >= InFlight(); }
+
+
+        private:
+        struct WindowSlot {
+            Packet frame;
+            unsigned long sentAt;
+            bool acked;
+            bool retransmitted;
+        }; // struct WindowSlot
+
+        WindowSlot window[Config::RELIABLE_WINDOW];
+        uint8_t sndBase; // oldest critical packet not acked
+        uint8_t sndNext; // sequence number of the next critical packet
+        uint8_t rcvNext; // next sequence number expected in order
+        uint32_t rcvMask; // bit i set when rcvNext+1+i has been received
+
+        // smoothed round trip time and its mean deviation, in ms
+        unsigned long srtt;
+        unsigned long rttvar;
+        unsigned long rto;
+
+
+        /// @brief Records a critical packet and acks it
+        /// @return True the first time a sequence number is seen, duplicates from retransmission return false
+        template <typename Manager> inline bool AcceptCritical(Manager& manager, uint8_t seq) {
+            const uint8_t d = seq - rcvNext;
+            bool fresh = false;
+
+            if (d == 0) {
+                // in order, slide past anything already received after it
+                fresh = true;
+                rcvNext++;
+                while (rcvMask & 1) {
+                    rcvMask >>= 1;
+                    rcvNext++;
+                }
+                rcvMask >>= 1;
+            } else if (d < Config::RELIABLE_WINDOW) {
+                // ahead of a gap, remember it for the selective ack
+                fresh = !(rcvMask & (1ul << (d-1)));
+                rcvMask |= (1ul << (d-1));
+            }
+
+            // anything else is an old duplicate whose ack was lost, ack again
+            SendAck(manager);
+            return fresh;
+        }
+
+        /// @brief Sends the cumulative ack and the selective ack bitmap, little endian
+        template <typename Manager> inline void SendAck(Manager& manager) {
+            const uint8_t ack[5] = {
+                rcvNext,
+                (uint8_t)rcvMask, (uint8_t)(rcvMask >> 8), (uint8_t)(rcvMask >> 16), (uint8_t)(rcvMask >> 24),
+            };
+
+            // a lost ack is recovered by the next retransmission
+            manager.SendFrame((typename Config::TypeId)Type::AckPacket, 0, ack, sizeof(ack));
+        }
+
+        /// @brief Marks packets covered by an ack and slides the window
+        inline void ProcessAck(const Packet& packet) {
+            // a short ack's missing bytes are whatever was left past it, never trust them
+            if (packet.PayloadLength() < 5) return;
+
+            const uint8_t cumulative = packet.payload[0];
+            const uint32_t mask = (uint32_t)packet.payload[1] | ((uint32_t)packet.payload[2] << 8) |
+                                  ((uint32_t)packet.payload[3] << 16) | ((uint32_t)packet.payload[4] << 24);
+
+            // acks for something never sent are stale or bogus
+            const uint8_t covered = cumulative - sndBase;
+            if (covered > InFlight()) return;
+
+            const unsigned long now = Millis();
+
+            for (uint8_t seq = sndBase; seq != sndNext; seq++) {
+                WindowSlot& slot = window[seq & (Config::RELIABLE_WINDOW-1)];
+                if (slot.acked) continue;
+
+                const uint8_t d = seq - cumulative;
+                if ((uint8_t)(seq - sndBase) < covered || (d >= 1 && d <= 32 && (mask & (1ul << (d-1))))) {
+                    slot.acked = true;
+
+                    // Karn, a retransmitted packet's ack can't tell which copy it answers
+                    if (!slot.retransmitted) SampleRtt(now - slot.sentAt);
+                }
+            }
+
+            while (sndBase != sndNext && window[sndBase & (Config::RELIABLE_WINDOW-1)].acked) {
+                sndBase++;
+            }
+        }
+
+        /// @brief Jacobson / Karels estimate, rto = srtt + 4 * rttvar
+        inline void SampleRtt(unsigned long rtt) {
+            if (srtt == 0) {
+                srtt = rtt ? rtt : 1;
+                rttvar = rtt / 2;
+            } else {
+                const unsigned long err = rtt > srtt ? rtt - srtt : srtt - rtt;
+                rttvar = rttvar - (rttvar >> 2) + (err >> 2);
+                srtt = srtt - (srtt >> 3) + (rtt >> 3);
+            }
+
+            rto = srtt + 4*rttvar;
+            if (rto < Config::RELIABLE_MIN_RTO) rto = Config::RELIABLE_MIN_RTO;
+            if (rto > Config::RELIABLE_MAX_RTO) rto = Config::RELIABLE_MAX_RTO;
+        }
+
+        static inline bool HasCritical(uint8_t flags) { return flags & 0b10000000; }
+    }; // struct Reliability
+
+} // namespace pckt
@@ -0,0 +1,111 @@
+#pragma once
+#include <string.h>
+#include "Transport.hpp"
+
+namespace trns {
+
+    /// @brief Picks the narrowest index, single byte loads are atomic on AVR without masking interrupts
+    template <bool Small> struct RingIndex { using Type = size_t; };
+    template <> struct RingIndex<true> { using Type = uint8_t; };
+
+
+    /// @brief Wait-free single producer / single consumer ring buffer transport
+    ///
+    /// The producer (UART RX interrupt, host reader thread, or write() for loopback) only
+    /// ever moves head, the consumer (PacketManager::Update) only ever moves tail
+    /// @tparam N Size of the ring in bytes, must be a power of two, holds up to N-1 bytes
+    template <size_t N> struct RingBufferTransport final : public pckt::Transport {
+        static_assert(N >= 2 && (N & (N-1)) == 0, "ring size must be a power of two");
+
+        public:
+        RingBufferTransport() : head(0), tail(0) {}
+
+
+        /// @brief Producer side, pushes a single byte, safe to call from an ISR
+        /// @return False if the ring is full and the byte was dropped
+        inline bool Push(uint8_t byte) {
+            const Index h = head;
+            const Index next = (h + 1) & MASK;
+            if (next == Load(tail)) {
+                return false;
+            }
+
+            buffer[h] = byte;
+            Store(head, next);
+            return true;
+        }
+
+        /// @brief Producer side, pushes as many bytes as fit
+        /// @return Number of bytes pushed
+        inline size_t Push(const uint8_t* data, size_t len) {
+            const Index h = head;
+            const size_t free = (Load(tail) - h - 1) & MASK;
+            if (len > free) len = free;
+
+            // at most two copies, up to the end of the ring then from the start
+            const size_t first = (N - h) < len ? (N - h) : len;
+            memcpy(buffer+h, data, first);
+            memcpy(buffer, data+first, len-first);
+
+            Store(head, (Index)((h + len) & MASK));
+            return len;
+        }
+
+
+        int read(uint8_t* data, size_t len) override {
+            size_t r = 0;
+            const uint8_t* span;
+
+            // ring wraps at most once
+            for (int i = 0; i < 2 && r < len; i++) {
+                size_t n = peek(span);
+                if (n == 0) break;
+                if (n > len - r) n = len - r;
+
+                memcpy(data+r, span, n);
+                consume(n);
+                r += n;
+            }
+
+            return (int)r;
+        }
+
+        /// @brief Loopback, written bytes are pushed as if they were received
+        size_t write(const uint8_t* data, size_t len) override { return Push(data, len); }
+
+        bool available() override { return Load(head) != tail; }
+
+        size_t peek(const uint8_t*& data) override {
+            const Index h = Load(head);
+            const Index t = tail;
+
+            data = buffer+t;
+            return h >= t ? h - t : N - t;
+        }
+
+        void consume(size_t len) override { Store(tail, (Index)((tail + len) & MASK)); }
+
+
+        /// @brief Number of bytes waiting to be read
+        inline size_t Size() const { return (Load(head) - Load(tail)) & MASK; }
+
+        /// @brief Number of bytes that can be pushed before the ring is full
+        inline size_t Free() const { return N - 1 - Size(); }
+
+        static constexpr size_t Capacity() { return N - 1; }
+
+
+        private:
+        using Index = typename RingIndex<(N <= 256)>::Type;
+        static constexpr Index MASK = (Index)(N - 1);
+
+        uint8_t buffer[N];
+        Index head;
+        Index tail;
+
+        // acquire / release pairs publish buffer contents between producer and consumer
+        static inline Index Load(const Index& i) { return __atomic_load_n(&i, __ATOMIC_ACQUIRE); }
+        static inline void Store(Index& i, Index v) { __atomic_store_n(&i, v, __ATOMIC_RELEASE); }
+    }; // struct RingBufferTransport
+
+} // namespace trns
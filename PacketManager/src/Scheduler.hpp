@@ -0,0 +1,158 @@
+#pragma once
+#include "Platform.hpp"
+#include "Packet.hpp"
+
+namespace pckt {
+
+    /// @brief Orders the frames of different channels within the tx queue, compiled away when TX_CHANNELS is 1
+    ///
+    /// The queue stays one contiguous run of wire bytes so a flush is still a single transport write, a new frame
+    /// is given a place among the frames the transport hasn't started on and the manager moves it there.
+    /// Weighted channels are also held to their share of the queue, a channel can only be written out
+    /// in proportion to its weight if it can't fill the queue by sending faster than the others
+    /// @tparam Capacity Most frames the tx queue can hold at once
+    template <typename Config, size_t Capacity, bool Enabled = (Config::TX_CHANNELS > 1)>
+    struct Scheduler {
+        public:
+        /// @brief Checks a frame of up to size bytes on channel may be queued
+        /// @param shared Queue bytes the channels other than 0 share
+        inline bool Admits(uint8_t channel, size_t size, size_t shared) const {
+            (void)channel; (void)size; (void)shared;
+            return true;
+        }
+
+        /// @brief Offset in the queue a new frame goes at, the frames from there on move up behind it
+        /// @param queued End of the queue, where the frame was built
+        inline size_t Place(uint8_t channel, size_t size, size_t queued) {
+            (void)channel; (void)size;
+            return queued;
+        }
+
+        /// @brief The transport has accepted every queued byte before head
+        inline void Written(size_t head) { (void)head; }
+
+        /// @brief n written bytes were dropped off the front of the queue, everything moved down by n
+        inline void Shifted(size_t n) { (void)n; }
+    }; // struct Scheduler
+
+
+    template <typename Config, size_t Capacity> struct Scheduler<Config, Capacity, true> {
+        static_assert(Config::TX_CHANNELS <= 16, "at most 16 channels");
+        static_assert(Config::TX_QUEUE_SIZE > 0 && Config::TX_QUEUE_SIZE <= 0xFFFF, "channels are scheduled within a tx queue of at most 64 KB");
+
+        public:
+        Scheduler() {
+            count = 0;
+            front = 0;
+            started = false;
+            virtualTime = 0;
+            weightSum = 0;
+
+            for (uint8_t c = 0; c < Config::TX_CHANNELS; c++) {
+                lastFinish[c] = 0;
+                backlog[c] = 0;
+                if (c) weightSum += Config::TxWeight(c);
+            }
+        }
+
+        inline bool Admits(uint8_t channel, size_t size, size_t shared) const {
+            if (Config::TX_SCHEDULE == Schedule::Strict || !channel || !backlog[channel]) return true;
+            return backlog[channel] + size <= shared * Config::TxWeight(channel) / weightSum;
+        }
+
+        inline size_t Place(uint8_t channel, size_t size, size_t queued) {
+            if (!count) {
+                front = queued;
+                started = false;
+            }
+
+            // self clocked fair queueing, a frame finishes size / weight after whichever is later,
+            // the last frame of its channel or the frame last written
+            uint32_t finish = 0;
+            if (Config::TX_SCHEDULE == Schedule::Weighted && channel) {
+                const uint32_t start = After(lastFinish[channel], virtualTime) ? lastFinish[channel] : virtualTime;
+                finish = start + ((uint32_t)size << 8) / Config::TxWeight(channel);
+                lastFinish[channel] = finish;
+            }
+
+            // pass every frame that goes after this one, a frame the transport has started on can't be passed
+            size_t i = count;
+            while (i > (started ? 1u : 0u) && GoesBefore(channel, finish, slots[i-1])) i--;
+
+            const size_t at = i ? slots[i-1].end : front;
+
+            for (size_t k = count; k > i; k--) {
+                slots[k] = slots[k-1];
+                slots[k].end += size;
+            }
+
+            slots[i].end = (uint16_t)(at + size);
+            slots[i].size = (uint16_t)size;
+            slots[i].channel = channel;
+            slots[i].finish = finish;
+            backlog[channel] += size;
+            count++;
+
+            return at;
+        }
+
+        inline void Written(size_t head) {
+            size_t done = 0;
+            while (done < count && slots[done].end <= head) {
+                if (slots[done].channel) virtualTime = slots[done].finish;
+                backlog[slots[done].channel] -= slots[done].size;
+                front = slots[done].end;
+                done++;
+            }
+
+            if (done) {
+                memmove(slots, slots + done, (count - done) * sizeof(Slot));
+                count -= done;
+
+                // idle channels catch up so their tags stay within reach of the wrap around compare
+                for (uint8_t c = 1; c < Config::TX_CHANNELS; c++) {
+                    if (After(virtualTime, lastFinish[c])) lastFinish[c] = virtualTime;
+                }
+            }
+
+            started = count && head > front;
+        }
+
+        inline void Shifted(size_t n) {
+            // a started frame can lose its first bytes, it stays started
+            front = front > n ? front - n : 0;
+            for (size_t i = 0; i < count; i++) {
+                slots[i].end -= n;
+            }
+        }
+
+
+        private:
+        struct Slot {
+            uint32_t finish; // virtual finish time, weighted channels other than 0 only
+            uint16_t end;    // queue offset one past the frame's last byte
+            uint16_t size;
+            uint8_t channel;
+        }; // struct Slot
+
+        Slot slots[Capacity];
+        size_t count;
+        size_t front;         // queue offset of the first frame in slots
+        bool started;         // the transport has taken part of the first frame
+        uint32_t virtualTime; // finish time of the last weighted frame written
+        uint32_t lastFinish[Config::TX_CHANNELS];
+        uint16_t backlog[Config::TX_CHANNELS]; // bytes of each channel in slots
+        uint16_t weightSum;                   // of every channel but 0
+
+        /// @brief Wrap around safe a > b
+        static inline bool After(uint32_t a, uint32_t b) { return (int32_t)(a - b) > 0; }
+
+        /// @brief Checks a new frame must be written before a queued one
+        static inline bool GoesBefore(uint8_t channel, uint32_t finish, const Slot& queued) {
+            if (Config::TX_SCHEDULE == Schedule::Strict) return channel < queued.channel;
+            if (!channel) return queued.channel != 0;
+            return queued.channel != 0 && After(queued.finish, finish);
+        }
+    }; // struct Scheduler
+
+} // namespace pckt
@@ -0,0 +1,118 @@
+#pragma once
+#include "Platform.hpp"
+
+namespace pckt {
+
+    /// @brief Copies a value's bytes to or from the wire, which is always little endian
+    template <typename M> struct Wire {
+        static inline void Write(const M& v, uint8_t* out) { Store(reinterpret_cast<const uint8_t*>(&v), out); }
+        static inline void Read(M& v, const uint8_t* in) { Store(in, reinterpret_cast<uint8_t*>(&v)); }
+
+        private:
+        static inline void Store(const uint8_t* from, uint8_t* to) {
+            if (LITTLE_ENDIAN_HOST) {
+                memcpy(to, from, sizeof(M));
+                return;
+            }
+
+            for (size_t i = 0; i < sizeof(M); i++) {
+                to[i] = from[sizeof(M)-1 - i];
+            }
+        }
+    }; // struct Wire
+
+    template <typename E, size_t N> struct Wire<E[N]> {
+        static inline void Write(const E (&v)[N], uint8_t* out) {
+            for (size_t i = 0; i < N; i++) Wire<E>::Write(v[i], out + i*sizeof(E));
+        }
+
+        static inline void Read(E (&v)[N], const uint8_t* in) {
+            for (size_t i = 0; i < N; i++) Wire<E>::Read(v[i], in + i*sizeof(E));
+        }
+    }; // struct Wire
+
+
+    /// @brief One member of a message on the wire, declare it with PCKT_FIELD
+    /// @tparam M Member type, an arithmetic or enum type or an array of them
+    /// @tparam Offset offsetof the member, lets the layout see whether the wire matches memory
+    template <typename T, typename M, M T::*Member, size_t Offset> struct Field {
+        static constexpr size_t SIZE = sizeof(M);
+        static constexpr size_t OFFSET = Offset;
+
+        static inline void Write(const T& msg, uint8_t* out) { Wire<M>::Write(msg.*Member, out); }
+        static inline void Read(T& msg, const uint8_t* in) { Wire<M>::Read(msg.*Member, in); }
+    }; // struct Field
+
+    #define PCKT_FIELD(T, member) pckt::Field<T, decltype(T::member), &T::member, offsetof(T, member)>
+
+
+    /// @brief Wire layout of the fields, back to back in the order given, little endian
+    template <typename T, size_t At, typename... Fields> struct FieldList {
+        static constexpr size_t SIZE = 0;
+        static constexpr bool SEQUENTIAL = true;
+
+        static inline void Write(const T& msg, uint8_t* out) { (void)msg; (void)out; }
+        static inline void Read(T& msg, const uint8_t* in) { (void)msg; (void)in; }
+    }; // struct FieldList
+
+    template <typename T, size_t At, typename F, typename... Rest> struct FieldList<T, At, F, Rest...> {
+        using Next = FieldList<T, At + F::SIZE, Rest...>;
+
+        static constexpr size_t SIZE = F::SIZE + Next::SIZE;
+
+        // every field sits in memory where it sits on the wire
+        static constexpr bool SEQUENTIAL = F::OFFSET == At && Next::SEQUENTIAL;
+
+        static inline void Write(const T& msg, uint8_t* out) {
+            F::Write(msg, out + At);
+            Next::Write(msg, out);
+        }
+
+        static inline void Read(T& msg, const uint8_t* in) {
+            F::Read(msg, in + At);
+            Next::Read(msg, in);
+        }
+    }; // struct FieldList
+
+
+    /// @brief Type id and wire layout of a message struct, what Schema is specialized with
+    ///
+    /// When the struct has no padding, lists every member in declaration order and the host is little endian
+    /// the wire matches memory, encoding and decoding are then a single memcpy
+    /// @tparam Id Packet type the message is sent as, below PACKET_COUNT or a sparse type, see SPARSE_HANDLERS
+    template <typename T, uint16_t Id, typename... Fields> struct Layout {
+        using List = FieldList<T, 0, Fields...>;
+
+        static constexpr uint16_t TYPE = Id;
+
+        /// @brief Payload bytes the message takes
+        static constexpr size_t SIZE = List::SIZE;
+
+        /// @brief The wire layout is the in-memory layout
+        static constexpr bool NATURAL = LITTLE_ENDIAN_HOST && List::SEQUENTIAL && sizeof(T) == SIZE;
+
+        static_assert(SIZE > 0, "a message needs at least one field");
+
+        static inline void Encode(const T& msg, uint8_t* out) {
+            if (NATURAL) memcpy(out, &msg, SIZE);
+            else List::Write(msg, out);
+        }
+
+        static inline void Decode(const uint8_t* in, T& msg) {
+            if (NATURAL) memcpy(&msg, in, SIZE);
+            else List::Read(msg, in);
+        }
+    }; // struct Layout
+
+
+    /// @brief Registers a message struct for PacketManager::Send<T> and Callback<T, handler>, specialize it
+    /// with a Layout after the struct is complete
+    ///
+    /// struct Pose { int32_t x, y; float heading; };
+    ///
+    /// namespace pckt {
+    ///     template <> struct Schema<Pose> : Layout<Pose, 1, PCKT_FIELD(Pose, x), PCKT_FIELD(Pose, y), PCKT_FIELD(Pose, heading)> {};
+    /// }
+    template <typename T> struct Schema;
+
+} // namespace pckt
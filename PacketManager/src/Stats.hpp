@@ -0,0 +1,90 @@
+#pragma once
+#include "Platform.hpp"
+
+namespace pckt {
+
+    /// @brief Snapshot of link health counters, every counter wraps around
+    struct LinkStats {
+        static constexpr size_t LATENCY_BUCKETS = 12;
+
+        uint32_t bytesIn;
+        uint32_t bytesOut;
+        uint32_t framesSent;      // committed to the transport, retransmissions and acks included
+        uint32_t framesDelivered; // verified and handed to the handler step
+
+        uint32_t resyncs;          // frame candidates thrown away, the search for a magic number restarted
+        uint32_t bytesSkipped;     // bytes that never became part of a delivered frame
+        uint32_t checksumFailures;
+        uint32_t badTypes;         // verified frames with a type >= PACKET_COUNT and no sparse handler
+        uint32_t timeouts;         // partial frames dropped after READ_TIMEOUT
+        uint32_t messagesDropped;  // incomplete messages given up after MESSAGE_TIMEOUT or for a newer one
+
+        // bucket i counts frames handed to their handler less than 2^i us into the Update that decoded them,
+        // the last bucket counts everything slower
+        uint32_t latency[LATENCY_BUCKETS];
+    }; // struct LinkStats
+
+
+    /// @brief Hot path counters behind PacketManager::Stats, compiled away when STATS is false
+    template <typename Config, bool Enabled = Config::STATS>
+    struct LinkCounters {
+        public:
+        inline void BytesIn(size_t n) { (void)n; }
+        inline void BytesOut(size_t n) { (void)n; }
+        inline void FrameSent() {}
+        inline void Resync() {}
+        inline void Skip(size_t n) { (void)n; }
+        inline void ChecksumFailure() {}
+        inline void BadType() {}
+        inline void Timeout(size_t dropped) { (void)dropped; }
+        inline void UpdateStarted() {}
+        inline void FrameDelivered() {}
+        inline void MessageDropped() {}
+
+        inline LinkStats Snapshot() const { LinkStats s; memset(&s, 0, sizeof(s)); return s; }
+        inline void Reset() {}
+    }; // struct LinkCounters
+
+
+    template <typename Config> struct LinkCounters<Config, true> {
+        public:
+        LinkCounters() { Reset(); }
+
+        inline void BytesIn(size_t n) { stats.bytesIn += n; }
+        inline void BytesOut(size_t n) { stats.bytesOut += n; }
+        inline void FrameSent() { stats.framesSent++; }
+        inline void Resync() { stats.resyncs++; }
+        inline void Skip(size_t n) { stats.bytesSkipped += n; }
+        inline void ChecksumFailure() { stats.checksumFailures++; }
+        inline void BadType() { stats.badTypes++; }
+
+        inline void Timeout(size_t dropped) {
+            stats.timeouts++;
+            stats.bytesSkipped += dropped;
+        }
+
+        inline void MessageDropped() { stats.messagesDropped++; }
+
+        inline void UpdateStarted() { updateStart = Micros(); }
+
+        inline void FrameDelivered() {
+            stats.framesDelivered++;
+
+            unsigned long us = Micros() - updateStart;
+            size_t bucket = 0;
+            while (us && bucket < LinkStats::LATENCY_BUCKETS-1) {
+                us >>= 1;
+                bucket++;
+            }
+            stats.latency[bucket]++;
+        }
+
+        inline LinkStats Snapshot() const { return stats; }
+        inline void Reset() { memset(&stats, 0, sizeof(stats)); updateStart = 0; }
+
+        private:
+        LinkStats stats;
+        unsigned long updateStart;
+    }; // struct LinkCounters
+
+} // namespace pckt
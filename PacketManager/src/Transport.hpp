@@ -0,0 +1,37 @@
+#pragma once
+#include <stdint.h>
+#include <stddef.h>
+
+namespace pckt {
+
+    /// @brief Transport layer abstraction
+    struct Transport {
+        public:
+        virtual int read(uint8_t* data, size_t len) = 0;
+        virtual size_t write(const uint8_t* data, size_t len) = 0;
+
+        virtual bool available() = 0;
+
+        /// @brief Exposes the next contiguous run of readable bytes without copying them
+        /// @param data Set to the first readable byte
+        /// @return Number of bytes in the run, 0 if nothing is readable or the transport has no spans
+        virtual size_t peek(const uint8_t*& data) { data = nullptr; return 0; }
+
+        /// @brief Releases bytes previously exposed by peek
+        /// @param len Number of bytes to release, must not exceed the last peek
+        virtual void consume(size_t len) { (void)len; }
+    }; // struct Transport
+
+
+    /// @brief Base for transports only ever bound to PacketManager<Config, T> directly, nothing is virtual so
+    /// there is no vtable and every call inlines, read / write / available must be provided by the derived type
+    struct StaticTransport {
+        public:
+        /// @brief No spans by default, hide it to expose them
+        inline size_t peek(const uint8_t*& data) { data = nullptr; return 0; }
+
+        /// @brief Nothing to release by default
+        inline void consume(size_t len) { (void)len; }
+    }; // struct StaticTransport
+
+} // namespace pckt
@@ -1,26 +1,195 @@
-#include "TestPacketManager.hpp"
+#include "../src/PacketManager.hpp"
+#include "../src/RingBufferTransport.hpp"
+#include "../src/PosixTransport.hpp"
+#include "../src/EventLoop.hpp"
+#include "../src/Gateway.hpp"
+#include "../src/Capture.hpp"
+#include "../src/Concurrent.hpp"
+#include "../src/Emulator.hpp"
 #include <queue>
 #include <iostream>
 #include <random>
+#include <thread>
+#include <memory>
+#include <stdlib.h>
+
+struct TestConfig : public pckt::DefaultConfig {
+    static constexpr unsigned long READ_TIMEOUT = 250;
+};
+
+struct VariableConfig : public TestConfig {
+    static constexpr size_t MAX_PAYLOAD_SIZE = 32;
+    static constexpr bool VARIABLE_LENGTH = true;
+    using Checksum = pckt::chk::Crc16Ccitt;
+};
+
+struct QueueConfig : public TestConfig {
+    static constexpr size_t TX_QUEUE_SIZE = 64;
+};
+
+struct ReliableConfig : public TestConfig {
+    static constexpr uint8_t RELIABLE_WINDOW = 8;
+    static constexpr unsigned long RELIABLE_INITIAL_RTO = 5;
+    static constexpr unsigned long RELIABLE_MIN_RTO = 1;
+    static constexpr unsigned long RELIABLE_MAX_RTO = 20;
+};
+
+struct VariableReliableConfig : public ReliableConfig {
+    static constexpr size_t MAX_PAYLOAD_SIZE = 32;
+    static constexpr bool VARIABLE_LENGTH = true;
+    using Checksum = pckt::chk::Crc16Ccitt;
+};
+
+struct CobsConfig : public TestConfig {
+    static constexpr pckt::Framing FRAMING = pckt::Framing::Cobs;
+    static constexpr size_t MAX_PAYLOAD_SIZE = 32;
+    static constexpr bool VARIABLE_LENGTH = true;
+    using Checksum = pckt::chk::Crc16Ccitt;
+};
+
+struct StatsConfig : public TestConfig {
+    static constexpr bool STATS = true;
+};
+
+struct ChannelConfig : public TestConfig {
+    static constexpr size_t TX_QUEUE_SIZE = 256;
+    static constexpr uint8_t TX_CHANNELS = 3;
+};
+
+struct WeightedConfig : public ChannelConfig {
+    static constexpr pckt::Schedule TX_SCHEDULE = pckt::Schedule::Weighted;
+    static constexpr uint8_t TxWeight(uint8_t channel) { return channel == 1 ? 3 : 1; }
+};
+
+struct MessageConfig : public TestConfig {
+    static constexpr size_t TX_QUEUE_SIZE = 64;
+    static constexpr size_t MESSAGE_POOL = 4;
+    static constexpr size_t MAX_MESSAGE_SIZE = 2048;
+    static constexpr unsigned long MESSAGE_TIMEOUT = 20;
+    static constexpr bool STATS = true;
+};
+
+struct DeltaConfig : public TestConfig {
+    static constexpr size_t MAX_PAYLOAD_SIZE = 65;
+    static constexpr bool VARIABLE_LENGTH = true;
+    static constexpr size_t DELTA_KEYFRAME = 32;
+    using Checksum = pckt::chk::Crc16Ccitt;
+};
+
+struct SchemaConfig : public TestConfig {
+    static constexpr size_t MAX_PAYLOAD_SIZE = 16;
+    static constexpr size_t PACKET_COUNT = 5;
+    static constexpr bool VARIABLE_LENGTH = true;
+};
+
+struct SparseConfig : public TestConfig {
+    using TypeId = uint16_t;
+    static constexpr size_t SPARSE_HANDLERS = 160;
+    static constexpr bool STATS = true;
+};
+
+struct CrowdedConfig : public TestConfig {
+    using TypeId = uint16_t;
+    static constexpr size_t SPARSE_HANDLERS = 32;
+};
+
+// a 9600 baud link's worth of bytes per second, frames of telemetry sent faster than it drains
+struct PacedConfig : public TestConfig {
+    static constexpr size_t TX_QUEUE_SIZE = 256;
+    static constexpr unsigned long TX_RATE = 960;
+    static constexpr size_t COALESCE_SLOTS = 1;
+    static constexpr bool STATS = true;
+};
+
+struct CoalesceConfig : public TestConfig {
+    static constexpr size_t TX_QUEUE_SIZE = 64;
+    static constexpr uint8_t TX_CHANNELS = 2;
+    static constexpr size_t COALESCE_SLOTS = 2;
+};
+
+struct ConcurrentConfig : public TestConfig {
+    static constexpr size_t TX_QUEUE_SIZE = 256;
+    static constexpr uint8_t RELIABLE_WINDOW = 8;
+    static constexpr unsigned long RELIABLE_INITIAL_RTO = 20;
+    static constexpr unsigned long RELIABLE_MIN_RTO = 5;
+    static constexpr unsigned long RELIABLE_MAX_RTO = 100;
+    static constexpr bool STATS = true;
+};
+
+// handler state of one message id, bound to its handler
+struct Route {
+    uint16_t id;
+    size_t expected;
+    size_t hits;
+
+    void OnPacket(const pckt::Packet<SparseConfig>& packet) {
+        uint16_t v;
+        memcpy(&v, packet.payload, sizeof(v));
+        if (packet.type == id && v == id) hits++;
+    }
+};
+
+// no padding, the wire is memory
+struct Pose {
+    int32_t x;
+    int32_t y;
+    float heading;
+    uint16_t flags;
+    uint8_t mode;
+    uint8_t seq;
+};
+
+// packed, handlers see it in place
+struct __attribute__((packed)) Reading {
+    uint8_t channel;
+    uint16_t raw;
+    int16_t scaled[2];
+};
+
+// padded and listed out of order, encoded field by field
+struct Status {
+    uint8_t id;
+    uint32_t uptime;
+    int16_t temp;
+};
+
+namespace pckt {
+    template <> struct Schema<Pose> : Layout<Pose, 3, PCKT_FIELD(Pose, x), PCKT_FIELD(Pose, y), PCKT_FIELD(Pose, heading),
+                                             PCKT_FIELD(Pose, flags), PCKT_FIELD(Pose, mode), PCKT_FIELD(Pose, seq)> {};
+    template <> struct Schema<Reading> : Layout<Reading, 4, PCKT_FIELD(Reading, channel), PCKT_FIELD(Reading, raw), PCKT_FIELD(Reading, scaled)> {};
+    template <> struct Schema<Status> : Layout<Status, 1, PCKT_FIELD(Status, uptime), PCKT_FIELD(Status, id), PCKT_FIELD(Status, temp)> {};
+}
+
+static_assert(pckt::Schema<Pose>::NATURAL && pckt::Schema<Pose>::SIZE == 16, "pose is sent as it is in memory");
+static_assert(pckt::Schema<Reading>::NATURAL && pckt::Schema<Reading>::SIZE == 7, "reading is sent as it is in memory");
+static_assert(!pckt::Schema<Status>::NATURAL && pckt::Schema<Status>::SIZE == 7, "status is encoded without its padding");
+
+using Manager = pckt::PacketManager<TestConfig>;
+using Packet = pckt::Packet<TestConfig>;
 
 struct TestTransportLayer : public pckt::Transport {
     public:
     TestTransportLayer() {}
 
     int read(uint8_t* data, size_t len) {
-        int r = 0;
+        size_t r = buffer.size() - head;
+        if (r > len) r = len;
 
-        for (size_t i = 0; i < len && available(); i++) {
-            data[i] = buffer[0];
-            buffer.erase(buffer.begin());
-            r++;
+        memcpy(data, buffer.data()+head, r);
+        head += r;
+
+        // everything consumed, reuse the allocation
+        if (head == buffer.size()) {
+            buffer.clear();
+            head = 0;
         }
 
-        return r;
+        return (int)r;
     }
 
     size_t write(const uint8_t* data, size_t len) {
         size_t r = 0;
+        writes++;
 
         for (size_t i = 0; i < len; i++) {
             buffer.push_back(data[i]);
@@ -31,10 +200,70 @@ struct TestTransportLayer : public pckt::Transport {
     }
 
     bool available() {
-        return !buffer.empty();
+        return head < buffer.size();
+    }
+
+    // spans are only exposed when enabled, capped at maxSpan to split frames across chunks
+    size_t peek(const uint8_t*& data) {
+        data = buffer.data()+head;
+        if (!spans) return 0;
+
+        size_t r = buffer.size() - head;
+        return r < maxSpan ? r : maxSpan;
+    }
+
+    void consume(size_t len) {
+        head += len;
+        if (head == buffer.size()) {
+            buffer.clear();
+            head = 0;
+        }
     }
 
+    bool spans = false;
+    size_t maxSpan = SIZE_MAX;
+    size_t writes = 0;
+
+    // unread bytes are [head, buffer.size())
     std::vector<uint8_t> buffer;
+    size_t head = 0;
+};
+
+/// @brief Send only transport accepting at most maxWrite bytes per write, like a full non-blocking fd
+struct ThrottledTransportLayer : public pckt::Transport {
+    public:
+    ThrottledTransportLayer(TestTransportLayer& target) : target(target) {}
+
+    int read(uint8_t* data, size_t len) { (void)data; (void)len; return 0; }
+
+    size_t write(const uint8_t* data, size_t len) {
+        return target.write(data, len < maxWrite ? len : maxWrite);
+    }
+
+    bool available() { return false; }
+
+    TestTransportLayer& target;
+    size_t maxWrite = SIZE_MAX;
+};
+
+/// @brief Reads from one buffer and writes to another, dropping each write with probability loss
+struct LossyTransportLayer : public pckt::Transport {
+    public:
+    LossyTransportLayer(TestTransportLayer& source, TestTransportLayer& target, uint32_t seed) : source(source), target(target), gen(seed) {}
+
+    int read(uint8_t* data, size_t len) { return source.read(data, len); }
+
+    size_t write(const uint8_t* data, size_t len) {
+        if (std::uniform_real_distribution<double>(0.0, 1.0)(gen) < loss) return len;
+        return target.write(data, len);
+    }
+
+    bool available() { return source.available(); }
+
+    TestTransportLayer& source;
+    TestTransportLayer& target;
+    std::mt19937 gen;
+    double loss = 0.0;
 };
 
 struct TestSuite {
@@ -42,9 +271,9 @@ struct TestSuite {
     static size_t elapsed;
     static size_t received;
     static size_t failed;
-    static uint8_t payload[MAX_PAYLOAD_SIZE];
+    static uint8_t payload[TestConfig::MAX_PAYLOAD_SIZE];
 
-    static void Handler(const pckt::Packet& packet) {
+    template <typename P> static void Handler(const P& packet) {
         if (
             packet.payload[0] == 0xCC &&
             packet.payload[1] == 0xCC &&
@@ -61,13 +290,228 @@ struct TestSuite {
         }
     }
     
+    static void VariableHandler(const pckt::Packet<VariableConfig>& packet) {
+        // payload i is len+i, so a wrong length or a shifted checksum shows up
+        bool ok = packet.len <= VariableConfig::MAX_PAYLOAD_SIZE;
+        for (size_t i = 0; ok && i < packet.len; i++) {
+            ok = packet.payload[i] == (uint8_t)(packet.len + i);
+        }
+
+        if (ok) TestSuite::received++;
+        else TestSuite::failed++;
+    }
+
+    // dense in delimiters and magic numbers
+    static uint8_t CobsPayloadByte(size_t len, size_t i) { return i%3 == 0 ? 0x00 : i%3 == 1 ? 0xAA : (uint8_t)len; }
+
+    static void CobsHandler(const pckt::Packet<CobsConfig>& packet) {
+        bool ok = packet.len <= CobsConfig::MAX_PAYLOAD_SIZE;
+        for (size_t i = 0; ok && i < packet.len; i++) {
+            ok = packet.payload[i] == CobsPayloadByte(packet.len, i);
+        }
+
+        if (ok) TestSuite::received++;
+        else TestSuite::failed++;
+    }
+
+    static std::vector<uint8_t> delivered;
+    static void ReliableHandler(const pckt::Packet<ReliableConfig>& packet) {
+        uint32_t v;
+        memcpy(&v, packet.payload, sizeof(v));
+
+        // every critical packet must arrive exactly once
+        if (v < delivered.size() && !delivered[v]++) TestSuite::received++;
+        else TestSuite::failed++;
+    }
+
+    // channel of every delivered frame in order
+    static std::vector<uint8_t> channels;
+    template <typename P> static void ChannelHandler(const P& packet) { channels.push_back(packet.payload[0]); }
+
+    // message byte i depends on the length so a fragment landing in the wrong place shows up
+    static uint8_t MessageByte(size_t len, size_t i) { return (uint8_t)(len*13 + i*7); }
+
+    static size_t messages;
+    static void MessageHandler(const pckt::Message& message) {
+        bool ok = message.type == (uint8_t)pckt::Type::DataPacket && message.length <= MessageConfig::MAX_MESSAGE_SIZE;
+        for (size_t i = 0; ok && i < message.length; i++) {
+            ok = message.data[i] == MessageByte(message.length, i);
+        }
+
+        if (ok) TestSuite::messages++;
+        else TestSuite::failed++;
+    }
+
+    // 64 byte telemetry struct i, a counter, a slow sensor reading and constant configuration
+    static void Telemetry(uint32_t i, uint8_t* payload) {
+        for (size_t k = 0; k < 64; k++) payload[k] = (uint8_t)(k*3);
+        memcpy(payload, &i, sizeof(i));
+        payload[4] = (uint8_t)(i/8);
+        payload[10] = (uint8_t)(i/50);
+    }
+
+    static void DeltaHandler(const pckt::Packet<DeltaConfig>& packet) {
+        uint32_t i;
+        memcpy(&i, packet.payload, sizeof(i));
+
+        uint8_t expected[64];
+        Telemetry(i, expected);
+        if (packet.len == sizeof(expected) && !memcmp(packet.payload, expected, sizeof(expected))) TestSuite::received++;
+        else TestSuite::failed++;
+    }
+
+    static std::queue<Pose> poses;
+    static std::queue<Reading> readings;
+    static std::queue<Status> statuses;
+
+    static void PoseHandler(const Pose& pose) {
+        if (!poses.empty() && !memcmp(&pose, &poses.front(), sizeof(pose))) TestSuite::received++;
+        else TestSuite::failed++;
+        if (!poses.empty()) poses.pop();
+    }
+
+    static void ReadingHandler(const Reading& reading) {
+        if (!readings.empty() && !memcmp(&reading, &readings.front(), sizeof(reading))) TestSuite::received++;
+        else TestSuite::failed++;
+        if (!readings.empty()) readings.pop();
+    }
+
+    static void StatusHandler(const Status& status) {
+        const bool ok = !statuses.empty() && status.id == statuses.front().id && status.uptime == statuses.front().uptime && status.temp == statuses.front().temp;
+        if (ok) TestSuite::received++;
+        else TestSuite::failed++;
+        if (!statuses.empty()) statuses.pop();
+    }
+
+    static void RouteHandler(Route& route, const pckt::Packet<SparseConfig>& packet) { route.OnPacket(packet); }
+
+    /// @brief Sends packetsToSend frames from txFd to rxFd with both managers driven by an event loop, then hangs up txFd
+    /// @param hangup The other end sees txFd closing, not so for datagrams
+    static void PosixLink(int txFd, int rxFd, size_t packetsToSend, bool hangup) {
+        trns::FdTransport<> txTransport(txFd, false);
+        trns::FdTransport<> rxTransport(rxFd);
+        Manager txManager(txTransport);
+        Manager rxManager(rxTransport);
+        trns::EventLoop<> loop;
+
+        rxManager.Callback(pckt::Type::DataPacket, Handler);
+        if (!loop.Add(txFd, txManager) || !loop.Add(rxFd, rxManager)) TestSuite::failed++;
+
+        const size_t before = TestSuite::received;
+
+        // bursts fill the fd, the loop must flush what it refused once it is writable again
+        for (size_t i = 0; i < packetsToSend; i++) {
+            while (txManager.Send(pckt::Type::DataPacket, TestSuite::payload, TestConfig::MAX_PAYLOAD_SIZE) == pckt::SendStatus::WouldBlock) {
+                loop.Poll(0);
+                TestSuite::elapsed++;
+            }
+
+            if (i % 1024 == 0) loop.Poll(0);
+        }
+
+        for (size_t idle = 0; TestSuite::received - before < packetsToSend && idle < 100; TestSuite::elapsed++) {
+            if (loop.Poll(10) <= 0) idle++;
+        }
+
+        if (TestSuite::received - before != packetsToSend) TestSuite::failed++;
+        if (!hangup) {
+            ::close(txFd);
+            return;
+        }
+
+        loop.Remove(txFd);
+        ::close(txFd);
+        for (size_t i = 0; i < 10 && loop.Size(); i++) loop.Poll(10);
+
+        if (loop.Size() || !rxTransport.Closed() || rxTransport.Error()) TestSuite::failed++;
+    }
+
+    // frames handed to the handler straight out of the transport's buffer rather than a copy of them
+    static TestTransportLayer* viewed;
+    static size_t inPlace;
+    static void ViewHandler(const pckt::Packet<VariableConfig>& packet) {
+        VariableHandler(packet);
+
+        const uint8_t* at = packet.self();
+        if (at >= viewed->buffer.data() && at < viewed->buffer.data() + viewed->buffer.size()) inPlace++;
+    }
+
+    // next sequence number expected from each gateway link
+    static std::vector<uint32_t> sequences;
+    static void GatewayFrame(const trns::Gateway<TestConfig>::Frame& frame) {
+        uint32_t seq, link;
+        memcpy(&seq, frame.packet.payload, sizeof(seq));
+        memcpy(&link, frame.packet.payload + 4, sizeof(link));
+
+        // every frame once, in order, tagged with the link it was sent on
+        if (link == frame.link && link < sequences.size() && seq == sequences[link]++) TestSuite::received++;
+        else TestSuite::failed++;
+    }
+
+    // frames of each sending thread handled in order and out of it, the handlers run on the worker of their type
+    static std::atomic<size_t> handled;
+    static std::atomic<size_t> mishandled;
+    static void ConcurrentHandler(const pckt::Packet<ConcurrentConfig>& packet) {
+        uint32_t seq, producer;
+        memcpy(&seq, packet.payload, sizeof(seq));
+        memcpy(&producer, packet.payload + 4, sizeof(producer));
+
+        const pckt::Type type = producer % 2 ? pckt::Type::None : pckt::Type::DataPacket;
+        if ((pckt::Type)packet.type == type && producer < sequences.size() && seq == sequences[producer]++) handled++;
+        else mishandled++;
+    }
+
+    // frames of VariableHandler sent through an emulated link, frames whose content checks out and the damage done
+    struct LinkRun {
+        size_t delivered;
+        size_t failed;
+        trns::LinkDamage damage;
+    };
+
+    static LinkRun RunLink(const trns::LinkModel& model, size_t packetsToSend) {
+        TestTransportLayer loopback;
+        trns::LinkEmulator<TestTransportLayer> link(loopback, model);
+        pckt::PacketManager<VariableConfig> txManager(link);
+        pckt::PacketManager<VariableConfig> rxManager(link);
+        rxManager.Callback(pckt::Type::DataPacket, VariableHandler);
+
+        const size_t receivedBefore = TestSuite::received;
+        const size_t failedBefore = TestSuite::failed;
+
+        uint8_t frame[VariableConfig::MAX_PAYLOAD_SIZE];
+        for (size_t i = 0; i < packetsToSend; i++) {
+            const size_t len = i % (VariableConfig::MAX_PAYLOAD_SIZE + 1);
+            for (size_t b = 0; b < len; b++) frame[b] = (uint8_t)(len + b);
+
+            txManager.Send(pckt::Type::DataPacket, frame, len);
+            if (i % 16 == 0) rxManager.Update();
+        }
+
+        while (link.available()) rxManager.Update();
+
+        LinkRun run = { TestSuite::received - receivedBefore, TestSuite::failed - failedBefore, link.Damage() };
+        TestSuite::received = receivedBefore;
+        TestSuite::failed = failedBefore;
+        return run;
+    }
+
+    // value and arrival time of every coalesced payload delivered
+    static std::vector<uint32_t> latest;
+    static std::vector<unsigned long> latestAt;
+    template <typename P> static void LatestHandler(const P& packet) {
+        uint32_t v;
+        memcpy(&v, packet.payload, sizeof(v));
+        latest.push_back(v);
+        latestAt.push_back(pckt::Micros());
+    }
+
     static void T1TestManager(size_t packetsToSend) {
         TestSuite::elapsed = 0;
         TestSuite::received = 0;
         TestSuite::failed = 0;
         TestTransportLayer transport;
-        pckt::PacketManager txManager(transport);
-        pckt::PacketManager rxManager(transport);
+        Manager txManager(transport);
+        Manager rxManager(transport);
 
         std::cout << "Running T1 (" << packetsToSend << " packets):\n";
 
@@ -75,7 +519,7 @@ struct TestSuite {
         
 
         for (size_t i = 0; i < packetsToSend; i++) {
-            txManager.Send(pckt::Type::DataPacket, TestSuite::payload, MAX_PAYLOAD_SIZE);
+            txManager.Send(pckt::Type::DataPacket, TestSuite::payload, TestConfig::MAX_PAYLOAD_SIZE);
             rxManager.Update();
             TestSuite::elapsed++;
         }
@@ -98,16 +542,15 @@ struct TestSuite {
         TestSuite::received = 0;
         TestSuite::failed = 0;
         TestTransportLayer transport;
-        pckt::PacketManager txManager(transport);
-        pckt::PacketManager rxManager(transport);
+        Manager txManager(transport);
+        Manager rxManager(transport);
 
         std::cout << "Running T2 (" << packetsToSend << " packets, " << interference << " bytes interference):\n";
 
         rxManager.Callback(pckt::Type::DataPacket, Handler);
         
 
-        std::random_device rd;
-        std::mt19937 gen(rd());
+        std::mt19937 gen(2);
         std::uniform_int_distribution<uint8_t> dist(0x00, 0xFF);
 
         for (size_t i = 0; i < packetsToSend; i++) {
@@ -117,7 +560,7 @@ struct TestSuite {
                 transport.buffer.push_back(dist(gen));
             }
 
-            txManager.Send(pckt::Type::DataPacket, TestSuite::payload, MAX_PAYLOAD_SIZE);
+            txManager.Send(pckt::Type::DataPacket, TestSuite::payload, TestConfig::MAX_PAYLOAD_SIZE);
             rxManager.Update();
             TestSuite::elapsed++;
         }
@@ -140,15 +583,15 @@ struct TestSuite {
         TestSuite::received = 0;
         TestSuite::failed = 0;
         TestTransportLayer transport;
-        pckt::PacketManager txManager(transport);
-        pckt::PacketManager rxManager(transport);
+        Manager txManager(transport);
+        Manager rxManager(transport);
 
         std::cout << "Running T3 (" << packetsToSend << " packets, " << packetsToSend/2 << " malformed):\n";
 
         rxManager.Callback(pckt::Type::DataPacket, Handler);
 
         for (size_t i = 0; i < packetsToSend; i++) {
-            txManager.Send(pckt::Type::DataPacket, TestSuite::payload, MAX_PAYLOAD_SIZE);
+            txManager.Send(pckt::Type::DataPacket, TestSuite::payload, TestConfig::MAX_PAYLOAD_SIZE);
             
             // malform every other packet
             if (i%2 == 0) transport.buffer.back() = 0xff;
@@ -175,19 +618,19 @@ struct TestSuite {
         TestSuite::received = 0;
         TestSuite::failed = 0;
         TestTransportLayer transport;
-        pckt::PacketManager txManager(transport);
-        pckt::PacketManager rxManager(transport);
+        Manager txManager(transport);
+        Manager rxManager(transport);
 
         std::cout << "Running T4 (" << packetsToSend << " packets):\n";
 
         rxManager.Callback(pckt::Type::DataPacket, Handler);
 
         // send first half of packet
-        txManager.Send(pckt::Type::DataPacket, TestSuite::payload, MAX_PAYLOAD_SIZE);
+        txManager.Send(pckt::Type::DataPacket, TestSuite::payload, TestConfig::MAX_PAYLOAD_SIZE);
         transport.buffer.erase(transport.buffer.begin()+transport.buffer.size()/2, transport.buffer.end());
 
         for (size_t i = 0; i < packetsToSend; i++) {
-            txManager.Send(pckt::Type::DataPacket, payload, MAX_PAYLOAD_SIZE);
+            txManager.Send(pckt::Type::DataPacket, payload, TestConfig::MAX_PAYLOAD_SIZE);
             rxManager.Update();
             TestSuite::elapsed++;
         }
@@ -210,19 +653,18 @@ struct TestSuite {
         TestSuite::received = 0;
         TestSuite::failed = 0;
         TestTransportLayer transport;
-        pckt::PacketManager txManager(transport);
-        pckt::PacketManager rxManager(transport);
+        Manager txManager(transport);
+        Manager rxManager(transport);
 
         std::cout << "Running T5 (" << packetsToSend << " packets):\n";
 
         rxManager.Callback(pckt::Type::DataPacket, Handler);
         
-        std::random_device rd;
-        std::mt19937 gen(rd());
+        std::mt19937 gen(5);
         std::uniform_int_distribution<uint8_t> dist(0x00, 0xFF);
 
         for (size_t i = 0; i < packetsToSend; i++) {
-            txManager.Send(pckt::Type::DataPacket, TestSuite::payload, MAX_PAYLOAD_SIZE);
+            txManager.Send(pckt::Type::DataPacket, TestSuite::payload, TestConfig::MAX_PAYLOAD_SIZE);
 
             // malformed packet, correct headers
             for (size_t r = transport.buffer.size()-10; r < transport.buffer.size(); r++) {
@@ -245,17 +687,1591 @@ struct TestSuite {
         std::cout << "\tFailed: " << TestSuite::failed << "/" << packetsToSend << " packets (" << failedPercent << "%)\n";
         std::cout << "\tRecieved " << TestSuite::received << "/0" << " packets\n\n";
     }
+    static void T6TestChecksum(size_t buffersToCheck) {
+        TestSuite::received = 0;
+        TestSuite::failed = 0;
+
+        std::cout << "Running T6 (" << buffersToCheck << " buffers):\n";
+
+        // reference values for "123456789"
+        const uint8_t check[9] = { '1', '2', '3', '4', '5', '6', '7', '8', '9' };
+        if (pckt::chk::Fletcher16::Compute(check, 9) != 0x1EDE) TestSuite::failed++;
+        if (pckt::chk::Crc16Ccitt::Compute(check, 9) != 0x29B1) TestSuite::failed++;
+        if (pckt::chk::Crc32<1>::Compute(check, 9) != 0xCBF43926) TestSuite::failed++;
+        if (pckt::chk::Crc32<4>::Compute(check, 9) != 0xCBF43926) TestSuite::failed++;
+        if (pckt::chk::Crc32<8>::Compute(check, 9) != 0xCBF43926) TestSuite::failed++;
+
+        std::mt19937 gen(6);
+        std::uniform_int_distribution<uint16_t> dist(0x00, 0xFF);
+        std::vector<uint8_t> buffer;
+
+        for (size_t i = 0; i < buffersToCheck; i++) {
+            buffer.resize(gen() % 512);
+            for (uint8_t& b : buffer) b = (uint8_t)dist(gen);
+
+            // original per-byte modulo fletcher16
+            uint16_t sum1 = 0;
+            uint16_t sum2 = 0;
+            for (uint8_t b : buffer) {
+                sum1 = (sum1 + b) % 255;
+                sum2 = (sum2 + sum1) % 255;
+            }
+
+            // byte at a time must match bulk
+            pckt::chk::Fletcher16::State f; pckt::chk::Fletcher16::Reset(f);
+            pckt::chk::Crc32<1>::State c; pckt::chk::Crc32<1>::Reset(c);
+            for (uint8_t b : buffer) {
+                pckt::chk::Fletcher16::Update(f, b);
+                pckt::chk::Crc32<1>::Update(c, b);
+            }
+
+            // sliding a fletcher sum along must match summing every window afresh
+            bool rolled = true;
+            if (buffer.size() > 1) {
+                const size_t w = 1 + gen() % (buffer.size()-1);
+                pckt::chk::Fletcher16::State r; pckt::chk::Fletcher16::Reset(r);
+                pckt::chk::Fletcher16::Update(r, buffer.data(), w);
+
+                for (size_t at = 1; at + w <= buffer.size(); at++) {
+                    pckt::chk::Fletcher16::Drop(r, buffer[at-1], w);
+                    pckt::chk::Fletcher16::Update(r, buffer[at+w-1]);
+                    rolled = rolled && pckt::chk::Fletcher16::Final(r) == pckt::chk::Fletcher16::Compute(buffer.data()+at, w);
+                }
+            }
+
+            const uint32_t crc = pckt::chk::Crc32<1>::Compute(buffer.data(), buffer.size());
+            if (
+                rolled &&
+                pckt::chk::Fletcher16::Compute(buffer.data(), buffer.size()) == ((sum2 << 8) | sum1) &&
+                pckt::chk::Fletcher16::Final(f) == ((sum2 << 8) | sum1) &&
+                pckt::chk::Crc32<1>::Final(c) == crc &&
+                pckt::chk::Crc32<4>::Compute(buffer.data(), buffer.size()) == crc &&
+                pckt::chk::Crc32<8>::Compute(buffer.data(), buffer.size()) == crc
+            ) {
+                TestSuite::received++;
+            } else {
+                TestSuite::failed++;
+            }
+        }
+
+        std::cout << "\tFailed: " << TestSuite::failed << " checks\n";
+        std::cout << "\tPassed " << TestSuite::received << "/" << buffersToCheck << " buffers\n\n";
+    }
+    static void T7TestRingBuffer(size_t packetsToSend) {
+        TestSuite::elapsed = 0;
+        TestSuite::received = 0;
+        TestSuite::failed = 0;
+        trns::RingBufferTransport<64> transport;
+
+        // bound to the concrete ring, calls into it are direct
+        pckt::PacketManager<TestConfig, trns::RingBufferTransport<64>> txManager(transport);
+        pckt::PacketManager<TestConfig, trns::RingBufferTransport<64>> rxManager(transport);
+
+        std::cout << "Running T7 (" << packetsToSend << " packets):\n";
+
+        rxManager.Callback(pckt::Type::DataPacket, Handler);
+
+        // the ring holds 63 bytes, frames land across the wrap point and updates only happen every few sends
+        for (size_t i = 0; i < packetsToSend; i++) {
+            txManager.Send(pckt::Type::DataPacket, TestSuite::payload, TestConfig::MAX_PAYLOAD_SIZE);
+            if (i%3 == 2) rxManager.Update();
+            TestSuite::elapsed++;
+        }
+
+        while (transport.available()) {
+            rxManager.Update();
+            TestSuite::elapsed++;
+        }
+
+        // pushing into a full ring must be refused, not overwrite
+        uint8_t fill[64] = {};
+        size_t pushed = transport.Push(fill, sizeof(fill));
+        if (pushed != transport.Capacity() || transport.Push(0) || transport.Free() != 0) TestSuite::failed++;
+
+        double failedPercent = 100.0 * (double)TestSuite::failed / (double)packetsToSend;
+        double recvPercent =   100.0 * (double)TestSuite::received / (double)packetsToSend;
+
+        std::cout << "\t" << TestSuite::elapsed << " updates elapsed\n";
+        std::cout << "\tFailed: " << TestSuite::failed << "/" << packetsToSend << " packets (" << failedPercent << "%)\n";
+        std::cout << "\tRecieved " << TestSuite::received << "/" << packetsToSend << " packets (" << recvPercent << "%)\n\n";
+    }
+    static void T8TestBatchDecode(size_t packetsToSend) {
+        TestSuite::elapsed = 0;
+        TestSuite::received = 0;
+        TestSuite::failed = 0;
+        TestTransportLayer transport;
+        Manager txManager(transport);
+        Manager rxManager(transport);
+
+        std::cout << "Running T8 (" << packetsToSend << " packets, " << packetsToSend/4 << " malformed):\n";
+
+        rxManager.Callback(pckt::Type::DataPacket, Handler);
+        transport.spans = true;
+
+        std::mt19937 gen(8);
+        std::uniform_int_distribution<uint16_t> dist(0x00, 0xFF);
+        size_t expected = 0;
+
+        for (size_t i = 0; i < packetsToSend; i++) {
+            // noise between frames
+            for (size_t p = gen() % 8; p > 0; p--) {
+                transport.buffer.push_back((uint8_t)dist(gen));
+            }
+
+            txManager.Send(pckt::Type::DataPacket, TestSuite::payload, TestConfig::MAX_PAYLOAD_SIZE);
+            if (i%4 == 0) transport.buffer.back() ^= 0x5A;
+            else expected++;
+
+            // several frames per chunk, split at random points
+            if (i%8 == 7) {
+                transport.maxSpan = 1 + gen() % (4*sizeof(Packet));
+                rxManager.Update();
+                TestSuite::elapsed++;
+            }
+        }
+
+        while (transport.available()) {
+            rxManager.Update();
+            TestSuite::elapsed++;
+        }
+
+        double failedPercent = 100.0 * (double)TestSuite::failed / (double)packetsToSend;
+        double recvPercent =   100.0 * (double)TestSuite::received / (double)expected;
+
+        std::cout << "\t" << TestSuite::elapsed << " updates elapsed\n";
+        std::cout << "\tFailed: " << TestSuite::failed << "/" << packetsToSend/4 << " packets (" << failedPercent << "%)\n";
+        std::cout << "\tRecieved " << TestSuite::received << "/" << expected << " packets (" << recvPercent << "%)\n\n";
+    }
+    static void T9TestPartialWrites(size_t packetsToSend) {
+        TestSuite::elapsed = 0;
+        TestSuite::received = 0;
+        TestSuite::failed = 0;
+        TestTransportLayer transport;
+        ThrottledTransportLayer throttled(transport);
+        Manager txManager(throttled);
+        Manager rxManager(transport);
+
+        std::cout << "Running T9 (" << packetsToSend << " packets):\n";
+
+        rxManager.Callback(pckt::Type::DataPacket, Handler);
+
+        std::mt19937 gen(9);
+        size_t blocked = 0;
+
+        for (size_t i = 0; i < packetsToSend; i++) {
+            // transport takes [0, 2*frame) bytes per write, frames get split and sometimes nothing goes out
+            throttled.maxWrite = gen() % (2*sizeof(Packet));
+
+            while (txManager.Send(pckt::Type::DataPacket, TestSuite::payload, TestConfig::MAX_PAYLOAD_SIZE) == pckt::SendStatus::WouldBlock) {
+                blocked++;
+                throttled.maxWrite = gen() % (2*sizeof(Packet));
+                txManager.Update();
+            }
+
+            rxManager.Update();
+            TestSuite::elapsed++;
+        }
+
+        throttled.maxWrite = SIZE_MAX;
+        if (txManager.Flush() != pckt::SendStatus::Sent || txManager.Pending()) TestSuite::failed++;
+
+        while (transport.available()) {
+            rxManager.Update();
+            TestSuite::elapsed++;
+        }
+
+        double failedPercent = 100.0 * (double)TestSuite::failed / (double)packetsToSend;
+        double recvPercent =   100.0 * (double)TestSuite::received / (double)packetsToSend;
+
+        std::cout << "\t" << TestSuite::elapsed << " updates elapsed, " << blocked << " sends would block\n";
+        std::cout << "\tFailed: " << TestSuite::failed << "/" << packetsToSend << " packets (" << failedPercent << "%)\n";
+        std::cout << "\tRecieved " << TestSuite::received << "/" << packetsToSend << " packets (" << recvPercent << "%)\n\n";
+    }
+    static void T10TestVariableLength(size_t packetsToSend) {
+        TestSuite::elapsed = 0;
+        TestSuite::received = 0;
+        TestSuite::failed = 0;
+        TestTransportLayer transport;
+        pckt::PacketManager<VariableConfig> txManager(transport);
+        pckt::PacketManager<VariableConfig> rxManager(transport);
+
+        std::cout << "Running T10 (" << packetsToSend << " packets, " << packetsToSend/4 << " malformed):\n";
+
+        rxManager.Callback(pckt::Type::DataPacket, VariableHandler);
+        transport.spans = true;
+
+        std::mt19937 gen(10);
+        std::uniform_int_distribution<uint16_t> dist(0x00, 0xFF);
+        size_t expected = 0;
+        size_t bytes = 0;
+
+        for (size_t i = 0; i < packetsToSend; i++) {
+            for (size_t p = gen() % 8; p > 0; p--) {
+                transport.buffer.push_back((uint8_t)dist(gen));
+            }
+
+            uint8_t payload[VariableConfig::MAX_PAYLOAD_SIZE];
+            const size_t len = gen() % (VariableConfig::MAX_PAYLOAD_SIZE+1);
+            for (size_t b = 0; b < len; b++) payload[b] = (uint8_t)(len + b);
+
+            const size_t before = transport.buffer.size();
+            txManager.Send(pckt::Type::DataPacket, payload, len);
+            bytes += transport.buffer.size() - before;
+
+            // corrupt the length byte of some, the frame must not be mistaken for a shorter or longer one
+            if (i%4 == 0) transport.buffer[before + pckt::Packet<VariableConfig>::HEADER_SIZE - 1] ^= 0x21;
+            else expected++;
+
+            if (i%8 == 7) {
+                transport.maxSpan = 1 + gen() % (4*sizeof(pckt::Packet<VariableConfig>));
+                rxManager.Update();
+                TestSuite::elapsed++;
+            }
+        }
+
+        while (transport.available()) {
+            rxManager.Update();
+            TestSuite::elapsed++;
+        }
+
+        // only the bytes used go on the wire
+        if (bytes >= packetsToSend * sizeof(pckt::Packet<VariableConfig>)) TestSuite::failed++;
+
+        double failedPercent = 100.0 * (double)TestSuite::failed / (double)packetsToSend;
+        double recvPercent =   100.0 * (double)TestSuite::received / (double)expected;
+
+        std::cout << "\t" << TestSuite::elapsed << " updates elapsed, " << (double)bytes / (double)packetsToSend << " bytes per frame\n";
+        std::cout << "\tFailed: " << TestSuite::failed << "/" << packetsToSend/4 << " packets (" << failedPercent << "%)\n";
+        std::cout << "\tRecieved " << TestSuite::received << "/" << expected << " packets (" << recvPercent << "%)\n\n";
+    }
+    static void T11TestTxQueue(size_t packetsToSend) {
+        TestSuite::elapsed = 0;
+        TestSuite::received = 0;
+        TestSuite::failed = 0;
+        TestTransportLayer transport;
+        ThrottledTransportLayer throttled(transport);
+        pckt::PacketManager<QueueConfig> txManager(throttled);
+        Manager rxManager(transport);
+
+        std::cout << "Running T11 (" << packetsToSend << " packets):\n";
+
+        rxManager.Callback(pckt::Type::DataPacket, Handler);
+
+        std::mt19937 gen(11);
+        size_t blocked = 0;
+
+        for (size_t i = 0; i < packetsToSend; i++) {
+            // mostly the transport takes everything, sometimes it stalls and the queue has to absorb it
+            throttled.maxWrite = gen() % 4 ? SIZE_MAX : gen() % sizeof(Packet);
+
+            while (txManager.Send(pckt::Type::DataPacket, TestSuite::payload, TestConfig::MAX_PAYLOAD_SIZE) == pckt::SendStatus::WouldBlock) {
+                blocked++;
+                throttled.maxWrite = gen() % (2*sizeof(Packet));
+                txManager.Update();
+            }
+
+            if (i%4 == 3) {
+                txManager.Flush();
+                rxManager.Update();
+                TestSuite::elapsed++;
+            }
+        }
+
+        throttled.maxWrite = SIZE_MAX;
+        if (txManager.Flush() != pckt::SendStatus::Sent || txManager.Pending()) TestSuite::failed++;
+
+        while (transport.available()) {
+            rxManager.Update();
+            TestSuite::elapsed++;
+        }
+
+        // frames sent between flushes go out together
+        if (transport.writes >= packetsToSend) TestSuite::failed++;
+
+        double failedPercent = 100.0 * (double)TestSuite::failed / (double)packetsToSend;
+        double recvPercent =   100.0 * (double)TestSuite::received / (double)packetsToSend;
+
+        std::cout << "\t" << TestSuite::elapsed << " updates elapsed, " << transport.writes << " writes, " << blocked << " sends would block\n";
+        std::cout << "\tFailed: " << TestSuite::failed << "/" << packetsToSend << " packets (" << failedPercent << "%)\n";
+        std::cout << "\tRecieved " << TestSuite::received << "/" << packetsToSend << " packets (" << recvPercent << "%)\n\n";
+    }
+    /// @brief Fills a reliable window, then forges an empty ack followed by bytes that read as an ack of everything
+    /// sent, decoded from the rx window or from a span
+    /// @return True if every frame is still in flight
+    static bool IgnoresShortAck(bool spans) {
+        TestTransportLayer toRx, toTx;
+        LossyTransportLayer txLink(toTx, toRx, 12);
+        pckt::PacketManager<VariableReliableConfig> txManager(txLink);
+        pckt::PacketManager<VariableReliableConfig> forger(toTx);
+        toTx.spans = spans;
+        txManager.SetCritical(true);
+
+        uint32_t sent = 0;
+        uint8_t payload[VariableReliableConfig::MAX_PAYLOAD_SIZE] = {};
+        while (sent < VariableReliableConfig::RELIABLE_WINDOW && txManager.Send(pckt::Type::DataPacket, payload, sizeof(payload)) != pckt::SendStatus::WouldBlock) sent++;
+
+        // the empty ack's checksum sits where the cumulative ack would, the unused seq picks one that acks
+        // everything sent, the data frame before it leaves a full mask in the rx window, the bytes after it in a span
+        using AckFrame = pckt::Packet<VariableReliableConfig>;
+        AckFrame ack;
+        ack.type = (uint8_t)pckt::Type::AckPacket;
+        ack.flags = 0;
+        ack.SetPayloadLength(0);
+        for (ack.seq = 0; ack.seq < 255; ack.seq++) {
+            ack.checksum = AckFrame::Checksum::Compute(ack.self(), AckFrame::HEADER_SIZE);
+            if ((uint8_t)ack.checksum == sent) break;
+        }
+
+        memcpy(ack.payload, &ack.checksum, sizeof(ack.checksum));
+        const uint8_t mask[5] = { (uint8_t)sent, 0xFF, 0xFF, 0xFF, 0xFF };
+        forger.Send(pckt::Type::DataPacket, mask, sizeof(mask));
+        toTx.write(ack.self(), ack.FrameSize());
+        toTx.write(mask, sizeof(mask));
+
+        txManager.Update();
+        return sent && txManager.InFlight() == sent;
+    }
+
+    static void T12TestReliable(size_t packetsToSend) {
+        TestSuite::elapsed = 0;
+        TestSuite::received = 0;
+        TestSuite::failed = 0;
+        TestSuite::delivered.assign(packetsToSend, 0);
+        TestTransportLayer toRx, toTx;
+        LossyTransportLayer txLink(toTx, toRx, 12), rxLink(toRx, toTx, 13);
+        pckt::PacketManager<ReliableConfig> txManager(txLink);
+        pckt::PacketManager<ReliableConfig> rxManager(rxLink);
+
+        std::cout << "Running T12 (" << packetsToSend << " packets, 20% of frames lost each way):\n";
+
+        rxManager.Callback(pckt::Type::DataPacket, ReliableHandler);
+        txManager.SetCritical(true);
+        txLink.loss = 0.2;
+        rxLink.loss = 0.2;
+
+        uint32_t next = 0;
+        size_t blocked = 0;
+
+        // retransmission runs on the clock, give it a few seconds at most
+        const unsigned long start = pckt::Millis();
+        while ((next < packetsToSend || txManager.InFlight()) && pckt::Millis() - start < 10000) {
+            if (next < packetsToSend) {
+                uint8_t payload[ReliableConfig::MAX_PAYLOAD_SIZE] = {};
+                memcpy(payload, &next, sizeof(next));
+                if (txManager.Send(pckt::Type::DataPacket, payload, sizeof(payload)) == pckt::SendStatus::WouldBlock) {
+                    blocked++;
+                    std::this_thread::sleep_for(std::chrono::microseconds(200));
+                } else {
+                    next++;
+                }
+            }
+
+            rxManager.Update();
+            txManager.Update();
+            TestSuite::elapsed++;
+        }
+
+        if (txManager.InFlight()) TestSuite::failed++;
+
+        // a short ack never acks what its missing bytes would have, whether they are read from the rx window or a span
+        if (!IgnoresShortAck(false) || !IgnoresShortAck(true)) TestSuite::failed++;
+
+        double failedPercent = 100.0 * (double)TestSuite::failed / (double)packetsToSend;
+        double recvPercent =   100.0 * (double)TestSuite::received / (double)packetsToSend;
+
+        std::cout << "\t" << TestSuite::elapsed << " updates elapsed, " << blocked << " sends would block\n";
+        std::cout << "\tFailed: " << TestSuite::failed << "/" << packetsToSend << " packets (" << failedPercent << "%)\n";
+        std::cout << "\tRecieved " << TestSuite::received << "/" << packetsToSend << " packets (" << recvPercent << "%)\n\n";
+    }
+    static void T13TestStats(size_t packetsToSend) {
+        TestSuite::elapsed = 0;
+        TestSuite::received = 0;
+        TestSuite::failed = 0;
+        TestTransportLayer transport;
+        pckt::PacketManager<StatsConfig> txManager(transport);
+        pckt::PacketManager<StatsConfig> rxManager(transport);
+
+        std::cout << "Running T13 (" << packetsToSend << " packets, " << packetsToSend/4 << " malformed):\n";
+
+        rxManager.Callback(pckt::Type::DataPacket, Handler);
+
+        std::mt19937 gen(13);
+        std::uniform_int_distribution<uint16_t> dist(0x00, 0xFF);
+        size_t expected = 0;
+        size_t noise = 0;
+
+        for (size_t i = 0; i < packetsToSend; i++) {
+            for (size_t p = gen() % 8; p > 0; p--) {
+                transport.buffer.push_back((uint8_t)dist(gen));
+                noise++;
+            }
+
+            txManager.Send(pckt::Type::DataPacket, TestSuite::payload, TestConfig::MAX_PAYLOAD_SIZE);
+            if (i%4 == 0) transport.buffer.back() ^= 0x5A;
+            else expected++;
+
+            // first half frame at a time, second half in place from spans
+            transport.spans = i >= packetsToSend/2;
+            if (i%8 == 7) {
+                transport.maxSpan = 1 + gen() % (4*sizeof(Packet));
+                rxManager.Update();
+                TestSuite::elapsed++;
+            }
+        }
+
+        while (transport.available()) {
+            rxManager.Update();
+            TestSuite::elapsed++;
+        }
+
+        // every byte read was either delivered or skipped
+        const pckt::LinkStats tx = txManager.Stats();
+        const pckt::LinkStats rx = rxManager.Stats();
+        uint32_t histogram = 0;
+        for (size_t b = 0; b < pckt::LinkStats::LATENCY_BUCKETS; b++) histogram += rx.latency[b];
+
+        if (tx.framesSent != packetsToSend || tx.bytesOut != packetsToSend*sizeof(Packet)) TestSuite::failed++;
+        if (rx.bytesIn != tx.bytesOut + noise) TestSuite::failed++;
+        if (rx.framesDelivered != TestSuite::received || histogram != rx.framesDelivered) TestSuite::failed++;
+        if (rx.bytesIn != rx.framesDelivered*sizeof(Packet) + rx.bytesSkipped) TestSuite::failed++;
+        if (rx.checksumFailures < packetsToSend/4 || rx.resyncs < rx.checksumFailures || rx.timeouts) TestSuite::failed++;
+
+        // a partial frame left past READ_TIMEOUT is dropped and counted
+        rxManager.ResetStats();
+        txManager.Send(pckt::Type::DataPacket, TestSuite::payload, TestConfig::MAX_PAYLOAD_SIZE);
+        transport.buffer.resize(transport.buffer.size() - 3);
+        rxManager.Update();
+        std::this_thread::sleep_for(std::chrono::milliseconds(TestConfig::READ_TIMEOUT + 20));
+        rxManager.Update();
+
+        const pckt::LinkStats timedOut = rxManager.Stats();
+        if (timedOut.timeouts != 1 || timedOut.bytesSkipped != sizeof(Packet) - 3 || timedOut.framesDelivered) TestSuite::failed++;
+
+        // without STATS nothing is counted
+        Manager plain(transport);
+        plain.Send(pckt::Type::DataPacket, TestSuite::payload, TestConfig::MAX_PAYLOAD_SIZE);
+        if (plain.Stats().framesSent || plain.Stats().bytesOut) TestSuite::failed++;
+
+        double failedPercent = 100.0 * (double)TestSuite::failed / (double)packetsToSend;
+        double recvPercent =   100.0 * (double)TestSuite::received / (double)expected;
+
+        std::cout << "\t" << TestSuite::elapsed << " updates elapsed, " << rx.resyncs << " resyncs, " << rx.bytesSkipped << " bytes skipped\n";
+        std::cout << "\tFailed: " << TestSuite::failed << "/" << packetsToSend << " packets (" << failedPercent << "%)\n";
+        std::cout << "\tRecieved " << TestSuite::received << "/" << expected << " packets (" << recvPercent << "%)\n\n";
+    }
+    static void T14TestCobs(size_t packetsToSend) {
+        TestSuite::elapsed = 0;
+        TestSuite::received = 0;
+        TestSuite::failed = 0;
+        TestTransportLayer transport;
+        pckt::PacketManager<CobsConfig> txManager(transport);
+        pckt::PacketManager<CobsConfig> rxManager(transport);
+
+        std::cout << "Running T14 (" << packetsToSend << " packets, " << packetsToSend/4 << " malformed):\n";
+
+        rxManager.Callback(pckt::Type::DataPacket, CobsHandler);
+
+        std::mt19937 gen(14);
+        std::uniform_int_distribution<uint16_t> dist(0x00, 0xFF);
+        size_t expected = 0;
+
+        for (size_t i = 0; i < packetsToSend; i++) {
+            // line noise while idle, ended by a delimiter
+            if (i%16 == 0) {
+                for (size_t p = gen() % 32; p > 0; p--) transport.buffer.push_back((uint8_t)dist(gen));
+                transport.buffer.push_back(0x00);
+            }
+
+            uint8_t payload[CobsConfig::MAX_PAYLOAD_SIZE];
+            const size_t len = gen() % (CobsConfig::MAX_PAYLOAD_SIZE+1);
+            for (size_t b = 0; b < len; b++) payload[b] = CobsPayloadByte(len, b);
+
+            const size_t before = transport.buffer.size();
+            txManager.Send(pckt::Type::DataPacket, payload, len);
+
+            // the only zero on the wire is the delimiter
+            for (size_t b = before; b < transport.buffer.size()-1; b++) {
+                if (transport.buffer[b] == 0x00) TestSuite::failed++;
+            }
+            if (transport.buffer.back() != 0x00) TestSuite::failed++;
+
+            // any one byte changed, the frame is lost but never the one after it
+            if (i%4 == 0) transport.buffer[before + gen() % (transport.buffer.size()-1-before)] ^= (uint8_t)(1 + gen() % 255);
+            else expected++;
+
+            transport.spans = i >= packetsToSend/2;
+            if (i%8 == 7) {
+                transport.maxSpan = 1 + gen() % (4*sizeof(pckt::Packet<CobsConfig>));
+                rxManager.Update();
+                TestSuite::elapsed++;
+            }
+        }
+
+        while (transport.available()) {
+            rxManager.Update();
+            TestSuite::elapsed++;
+        }
+
+        double failedPercent = 100.0 * (double)TestSuite::failed / (double)packetsToSend;
+        double recvPercent =   100.0 * (double)TestSuite::received / (double)expected;
+
+        std::cout << "\t" << TestSuite::elapsed << " updates elapsed\n";
+        std::cout << "\tFailed: " << TestSuite::failed << "/" << packetsToSend/4 << " packets (" << failedPercent << "%)\n";
+        std::cout << "\tRecieved " << TestSuite::received << "/" << expected << " packets (" << recvPercent << "%)\n\n";
+    }
+    static void T15TestResync(size_t packetsToSend) {
+        TestSuite::elapsed = 0;
+        TestSuite::received = 0;
+        TestSuite::failed = 0;
+        TestTransportLayer transport;
+        pckt::PacketManager<StatsConfig> txManager(transport);
+        pckt::PacketManager<StatsConfig> rxManager(transport);
+
+        std::cout << "Running T15 (" << packetsToSend << " packets, " << packetsToSend/4 << " malformed):\n";
+
+        rxManager.Callback(pckt::Type::DataPacket, Handler);
+
+        std::mt19937 gen(15);
+        size_t expected = 0;
+        size_t garbage = 0;
+
+        for (size_t i = 0; i < packetsToSend; i++) {
+            // up to 3 frames worth of bytes that all look like the start of one, magic numbers or whole headers
+            const bool headers = gen() % 2;
+            for (size_t p = gen() % (3*sizeof(Packet)); p > 0; p--) {
+                const size_t at = transport.buffer.size();
+                transport.buffer.push_back(!headers || at%3 == 0 ? TestConfig::MAGIC_NUM : at%3 == 1 ? (uint8_t)pckt::Type::DataPacket : 0);
+                garbage++;
+            }
+
+            txManager.Send(pckt::Type::DataPacket, TestSuite::payload, TestConfig::MAX_PAYLOAD_SIZE);
+            if (i%4 == 0) transport.buffer.back() ^= 0x5A;
+            else expected++;
+
+            // first half frame at a time, second half in place from spans
+            transport.spans = i >= packetsToSend/2;
+            if (i%8 == 7) {
+                transport.maxSpan = 1 + gen() % (4*sizeof(Packet));
+                rxManager.Update();
+                TestSuite::elapsed++;
+            }
+        }
+
+        while (transport.available()) {
+            rxManager.Update();
+            TestSuite::elapsed++;
+        }
+
+        // every byte read was either delivered or skipped, nothing waits in the rx window
+        const pckt::LinkStats rx = rxManager.Stats();
+        if (rx.bytesIn != packetsToSend*sizeof(Packet) + garbage) TestSuite::failed++;
+        if (rx.bytesIn != rx.framesDelivered*sizeof(Packet) + rx.bytesSkipped) TestSuite::failed++;
+
+        double failedPercent = 100.0 * (double)TestSuite::failed / (double)packetsToSend;
+        double recvPercent =   100.0 * (double)TestSuite::received / (double)expected;
+
+        std::cout << "\t" << TestSuite::elapsed << " updates elapsed, " << rx.resyncs << " resyncs\n";
+        std::cout << "\tFailed: " << TestSuite::failed << "/" << packetsToSend/4 << " packets (" << failedPercent << "%)\n";
+        std::cout << "\tRecieved " << TestSuite::received << "/" << expected << " packets (" << recvPercent << "%)\n\n";
+    }
+    static void T16TestChannels(size_t packetsToSend) {
+        TestSuite::elapsed = 0;
+        TestSuite::received = 0;
+        TestSuite::failed = 0;
+        TestTransportLayer transport;
+        ThrottledTransportLayer throttled(transport);
+        pckt::PacketManager<ChannelConfig> txManager(throttled);
+        pckt::PacketManager<ChannelConfig> rxManager(transport);
+
+        std::cout << "Running T16 (" << packetsToSend << " packets):\n";
+
+        rxManager.Callback(pckt::Type::DataPacket, ChannelHandler);
+
+        std::mt19937 gen(16);
+        uint8_t payload[TestConfig::MAX_PAYLOAD_SIZE] = {};
+        size_t sent = 0;
+        size_t blocked = 0;
+        bool awaiting = false;
+        size_t allowed = 0;
+        size_t overtaken = 0;
+
+        // telemetry on channels 1 and 2 keeps the queue full, a critical packet may only wait for the frames
+        // already on the wire and the one the transport has started on
+        for (size_t i = 0; i < packetsToSend; i++) {
+            payload[0] = 1 + gen() % 2;
+            txManager.SetChannel(payload[0]);
+            if (txManager.Send(pckt::Type::DataPacket, payload, sizeof(payload)) == pckt::SendStatus::WouldBlock) blocked++;
+            else sent++;
+
+            if (i%16 == 0 && !awaiting) {
+                payload[0] = 0;
+                txManager.SetCritical(true);
+                if (txManager.Send(pckt::Type::DataPacket, payload, sizeof(payload)) == pckt::SendStatus::WouldBlock) TestSuite::failed++;
+                txManager.SetCritical(false);
+
+                sent++;
+                awaiting = true;
+                // the unread bytes may start and end part way through a frame
+                allowed = (transport.buffer.size() - transport.head + sizeof(Packet)-1) / sizeof(Packet) + 1;
+                overtaken = 0;
+            }
+
+            throttled.maxWrite = 1 + gen() % (2*sizeof(Packet));
+            txManager.Update();
+            rxManager.Update();
+            TestSuite::elapsed++;
+
+            for (uint8_t c : channels) {
+                if (!awaiting) continue;
+                if (c != 0) {
+                    overtaken++;
+                    continue;
+                }
+
+                if (overtaken > allowed) TestSuite::failed++;
+                awaiting = false;
+            }
+            TestSuite::received += channels.size();
+            channels.clear();
+        }
+
+        throttled.maxWrite = SIZE_MAX;
+        while (txManager.Pending()) txManager.Flush();
+        while (transport.available()) rxManager.Update();
+        TestSuite::received += channels.size();
+        if (TestSuite::received != sent) TestSuite::failed++;
+
+        // with nothing written yet, 8 frames on channel 2 then 8 on channel 1, strict drains channel 1 first,
+        // weighted 3:1 only queues 4 of channel 2 and lets 3 of channel 1 through per frame of channel 2
+        const uint8_t strictOrder[16] = { 1, 1, 1, 1, 1, 1, 1, 1, 2, 2, 2, 2, 2, 2, 2, 2 };
+        const uint8_t weightedOrder[12] = { 1, 1, 1, 2, 1, 1, 1, 2, 1, 1, 2, 2 };
+
+        pckt::PacketManager<WeightedConfig> weightedTx(throttled);
+        pckt::PacketManager<WeightedConfig> weightedRx(transport);
+        weightedRx.Callback(pckt::Type::DataPacket, ChannelHandler);
+
+        for (int weighted = 0; weighted < 2; weighted++) {
+            throttled.maxWrite = 0;
+            for (uint8_t c = 2; c >= 1; c--) {
+                payload[0] = c;
+                for (int n = 0; n < 8; n++) {
+                    if (weighted) { weightedTx.SetChannel(c); weightedTx.Send(pckt::Type::DataPacket, payload, sizeof(payload)); }
+                    else { txManager.SetChannel(c); txManager.Send(pckt::Type::DataPacket, payload, sizeof(payload)); }
+                }
+            }
+
+            throttled.maxWrite = SIZE_MAX;
+            channels.clear();
+            if (weighted) { weightedTx.Flush(); while (transport.available()) weightedRx.Update(); }
+            else { txManager.Flush(); while (transport.available()) rxManager.Update(); }
+
+            const uint8_t* expected = weighted ? weightedOrder : strictOrder;
+            const size_t frames = weighted ? sizeof(weightedOrder) : sizeof(strictOrder);
+            if (channels.size() != frames || memcmp(channels.data(), expected, frames)) TestSuite::failed++;
+        }
+
+        double failedPercent = 100.0 * (double)TestSuite::failed / (double)packetsToSend;
+        double recvPercent =   100.0 * (double)TestSuite::received / (double)sent;
+
+        std::cout << "\t" << TestSuite::elapsed << " updates elapsed, " << blocked << " sends would block\n";
+        std::cout << "\tFailed: " << TestSuite::failed << "/" << packetsToSend << " packets (" << failedPercent << "%)\n";
+        std::cout << "\tRecieved " << TestSuite::received << "/" << sent << " packets (" << recvPercent << "%)\n\n";
+    }
+    static void T17TestMessages(size_t messagesToSend) {
+        TestSuite::elapsed = 0;
+        TestSuite::received = 0;
+        TestSuite::failed = 0;
+        TestSuite::messages = 0;
+        TestTransportLayer transport;
+        ThrottledTransportLayer throttled(transport);
+        pckt::PacketManager<MessageConfig> txManager(throttled);
+        pckt::PacketManager<MessageConfig> rxManager(transport);
+
+        std::cout << "Running T17 (" << messagesToSend << " messages):\n";
+
+        rxManager.Callback(pckt::Type::DataPacket, Handler);
+        if (!rxManager.MessageCallback(pckt::Type::DataPacket, MessageHandler)) TestSuite::failed++;
+        if (rxManager.MessageCallback((pckt::Type)MessageConfig::PACKET_COUNT, MessageHandler)) TestSuite::failed++;
+
+        // messages are read from in place, every buffer lives until the end
+        std::mt19937 gen(17);
+        std::vector<std::vector<uint8_t>> buffers;
+        size_t packets = 0;
+        size_t blocked = 0;
+
+        // up to 4 messages of up to 2 KB in flight at once, plain packets in between them
+        while (buffers.size() < messagesToSend) {
+            const size_t len = gen() % 4 == 0 ? gen() % 16 : gen() % (MessageConfig::MAX_MESSAGE_SIZE+1);
+            std::vector<uint8_t> buffer(len);
+            for (size_t i = 0; i < len; i++) buffer[i] = MessageByte(len, i);
+
+            if (txManager.SendMessage(pckt::Type::DataPacket, buffer.data(), len) == pckt::SendStatus::WouldBlock) blocked++;
+            else buffers.push_back(std::move(buffer));
+
+            if (gen() % 2 && txManager.Send(pckt::Type::DataPacket, TestSuite::payload, sizeof(TestSuite::payload)) != pckt::SendStatus::WouldBlock) packets++;
+
+            throttled.maxWrite = gen() % (4*sizeof(Packet));
+            txManager.Update();
+            transport.spans = gen() % 2;
+            rxManager.Update();
+            TestSuite::elapsed++;
+        }
+
+        throttled.maxWrite = SIZE_MAX;
+        while (txManager.MessagesPending() || txManager.Pending()) txManager.Update();
+        while (transport.available()) rxManager.Update();
+
+        if (TestSuite::messages != messagesToSend || TestSuite::received != packets) TestSuite::failed++;
+        if (rxManager.Stats().messagesDropped) TestSuite::failed++;
+
+        // too long for a pool buffer, or every outgoing slot taken
+        std::vector<uint8_t> large(MessageConfig::MAX_MESSAGE_SIZE+1);
+        if (txManager.SendMessage(pckt::Type::DataPacket, large.data(), large.size()) != pckt::SendStatus::TooLarge) TestSuite::failed++;
+
+        throttled.maxWrite = 0;
+        for (size_t i = 0; i < MessageConfig::MESSAGE_POOL; i++) {
+            if (txManager.SendMessage(pckt::Type::DataPacket, large.data(), 100) != pckt::SendStatus::Queued) TestSuite::failed++;
+        }
+        if (txManager.SendMessage(pckt::Type::DataPacket, large.data(), 100) != pckt::SendStatus::WouldBlock) TestSuite::failed++;
+
+        throttled.maxWrite = SIZE_MAX;
+        while (txManager.MessagesPending() || txManager.Pending()) txManager.Update();
+        transport.buffer.clear();
+        transport.head = 0;
+
+        // a lost fragment holds its message until it times out, the pool buffer is then free for the next one
+        std::vector<uint8_t> buffer(100);
+        for (size_t i = 0; i < buffer.size(); i++) buffer[i] = MessageByte(buffer.size(), i);
+
+        const size_t before = TestSuite::messages;
+        txManager.SendMessage(pckt::Type::DataPacket, buffer.data(), buffer.size());
+        while (txManager.MessagesPending() || txManager.Pending()) txManager.Update();
+        transport.buffer.erase(transport.buffer.begin() + 2*sizeof(Packet), transport.buffer.begin() + 3*sizeof(Packet));
+        while (transport.available()) rxManager.Update();
+
+        std::this_thread::sleep_for(std::chrono::milliseconds(2*MessageConfig::MESSAGE_TIMEOUT));
+        rxManager.Update();
+        if (TestSuite::messages != before || rxManager.Stats().messagesDropped != 1) TestSuite::failed++;
+
+        txManager.SendMessage(pckt::Type::DataPacket, buffer.data(), buffer.size());
+        while (txManager.MessagesPending() || txManager.Pending()) txManager.Update();
+        while (transport.available()) rxManager.Update();
+        if (TestSuite::messages != before + 1) TestSuite::failed++;
+
+        // a late fragment of a longer message whose id came around again, in before fragment 0 of the shorter one
+        // and standing in for the fragment it lost, doesn't complete it
+        std::vector<uint8_t> longer(400);
+        txManager.SendMessage(pckt::Type::DataPacket, longer.data(), longer.size());
+        while (txManager.MessagesPending() || txManager.Pending()) txManager.Update();
+        const std::vector<uint8_t> stray(transport.buffer.end() - sizeof(Packet), transport.buffer.end());
+
+        for (size_t i = 0; i < 256; i++) {
+            transport.buffer.clear();
+            transport.head = 0;
+            txManager.SendMessage(pckt::Type::DataPacket, buffer.data(), buffer.size());
+            while (txManager.MessagesPending() || txManager.Pending()) txManager.Update();
+        }
+
+        transport.buffer.erase(transport.buffer.begin() + 2*sizeof(Packet), transport.buffer.begin() + 3*sizeof(Packet));
+        transport.buffer.insert(transport.buffer.begin(), stray.begin(), stray.end());
+        while (transport.available()) rxManager.Update();
+
+        std::this_thread::sleep_for(std::chrono::milliseconds(2*MessageConfig::MESSAGE_TIMEOUT));
+        rxManager.Update();
+        if (TestSuite::messages != before + 1 || rxManager.Stats().messagesDropped != 2) TestSuite::failed++;
+
+        double failedPercent = 100.0 * (double)TestSuite::failed / (double)messagesToSend;
+        double recvPercent =   100.0 * (double)TestSuite::messages / (double)(messagesToSend + 1);
+
+        std::cout << "\t" << TestSuite::elapsed << " updates elapsed, " << blocked << " messages would block, " << packets << " packets between them\n";
+        std::cout << "\tFailed: " << TestSuite::failed << "/" << messagesToSend << " messages (" << failedPercent << "%)\n";
+        std::cout << "\tRecieved " << TestSuite::messages << "/" << messagesToSend + 1 << " messages (" << recvPercent << "%)\n\n";
+    }
+    static void T18TestDelta(size_t packetsToSend) {
+        TestSuite::elapsed = 0;
+        TestSuite::received = 0;
+        TestSuite::failed = 0;
+        TestTransportLayer transport, unused;
+        LossyTransportLayer lossy(unused, transport, 18);
+        pckt::PacketManager<DeltaConfig> txManager(lossy);
+        pckt::PacketManager<DeltaConfig> rxManager(transport);
+
+        std::cout << "Running T18 (" << packetsToSend << " packets, 10% of frames lost in the second half):\n";
+
+        rxManager.Callback(pckt::Type::DataPacket, DeltaHandler);
+
+        // a plain frame of the 64 byte struct, header, length byte and checksum included
+        const size_t plain = pckt::Packet<DeltaConfig>::HEADER_SIZE + 64 + sizeof(uint16_t);
+        size_t bytes = 0;
+        size_t half = 0;
+        uint8_t payload[64];
+
+        for (uint32_t i = 0; i < packetsToSend; i++) {
+            if (i == packetsToSend/2) {
+                half = TestSuite::received;
+                lossy.loss = 0.1;
+            }
+
+            Telemetry(i, payload);
+            txManager.Send(pckt::Type::DataPacket, payload, sizeof(payload));
+            if (!lossy.loss) bytes += transport.buffer.size() - transport.head;
+
+            rxManager.Update();
+            TestSuite::elapsed++;
+        }
+
+        // every frame of the lossless half arrives, the slowly changing struct takes under a third of the bytes
+        if (half != packetsToSend/2) TestSuite::failed++;
+        if (3*bytes > plain*(packetsToSend/2)) TestSuite::failed++;
+
+        double failedPercent = 100.0 * (double)TestSuite::failed / (double)packetsToSend;
+        double recvPercent =   100.0 * (double)TestSuite::received / (double)packetsToSend;
+
+        std::cout << "\t" << (double)bytes / (packetsToSend/2) << " bytes per frame against " << plain << " plain\n";
+        std::cout << "\tFailed: " << TestSuite::failed << "/" << packetsToSend << " packets (" << failedPercent << "%)\n";
+        std::cout << "\tRecieved " << TestSuite::received << "/" << packetsToSend << " packets (" << recvPercent << "%)\n\n";
+    }
+    static void T19TestSchema(size_t packetsToSend) {
+        TestSuite::elapsed = 0;
+        TestSuite::received = 0;
+        TestSuite::failed = 0;
+        TestTransportLayer transport;
+        pckt::PacketManager<SchemaConfig> txManager(transport);
+        pckt::PacketManager<SchemaConfig> rxManager(transport);
+
+        std::cout << "Running T19 (" << packetsToSend << " packets):\n";
+
+        rxManager.Callback<Pose, PoseHandler>();
+        rxManager.Callback<Reading, ReadingHandler>();
+        rxManager.Callback<Status, StatusHandler>();
+
+        // fields land little endian in declaration order, status without its padding and in listed order
+        const Status status = { 0x11, 0x04030201, -2 };
+        txManager.Send(status);
+        const uint8_t expected[7] = { 0x01, 0x02, 0x03, 0x04, 0x11, 0xFE, 0xFF };
+        const size_t header = pckt::Packet<SchemaConfig>::HEADER_SIZE;
+        if (transport.buffer.size() < header + sizeof(expected) || memcmp(transport.buffer.data() + header, expected, sizeof(expected))) TestSuite::failed++;
+        if (transport.buffer[header-1] != sizeof(expected)) TestSuite::failed++;
+        statuses.push(status);
+        rxManager.Update();
+
+        // too short to be a pose, dropped before the handler
+        const uint8_t part[4] = {};
+        txManager.Send((pckt::Type)pckt::Schema<Pose>::TYPE, part, sizeof(part));
+        rxManager.Update();
+
+        std::mt19937 gen(19);
+        for (size_t i = 0; i < packetsToSend; i++) {
+            switch (gen() % 3) {
+                case 0: {
+                    const Pose pose = { (int32_t)gen(), (int32_t)gen(), (float)(gen() % 3600) / 10.0f, (uint16_t)gen(), (uint8_t)gen(), (uint8_t)i };
+                    poses.push(pose);
+                    txManager.Send(pose);
+                    break;
+                }
+                case 1: {
+                    const Reading reading = { (uint8_t)gen(), (uint16_t)gen(), { (int16_t)gen(), (int16_t)gen() } };
+                    readings.push(reading);
+                    txManager.Send(reading);
+                    break;
+                }
+                default: {
+                    const Status s = { (uint8_t)gen(), (uint32_t)gen(), (int16_t)gen() };
+                    statuses.push(s);
+                    txManager.Send(s);
+                }
+            }
+
+            rxManager.Update();
+            TestSuite::elapsed++;
+        }
+
+        if (!poses.empty() || !readings.empty() || !statuses.empty()) TestSuite::failed++;
+
+        double failedPercent = 100.0 * (double)TestSuite::failed / (double)packetsToSend;
+        double recvPercent =   100.0 * (double)TestSuite::received / (double)(packetsToSend + 1);
+
+        std::cout << "\tFailed: " << TestSuite::failed << "/" << packetsToSend << " packets (" << failedPercent << "%)\n";
+        std::cout << "\tRecieved " << TestSuite::received << "/" << packetsToSend + 1 << " packets (" << recvPercent << "%)\n\n";
+    }
+    static void T20TestPosix(size_t packetsToSend) {
+        TestSuite::elapsed = 0;
+        TestSuite::received = 0;
+        TestSuite::failed = 0;
+
+        std::cout << "Running T20 (" << 3*packetsToSend << " packets):\n";
+
+        int pair[2];
+        if (socketpair(AF_UNIX, SOCK_STREAM, 0, pair) == 0) PosixLink(pair[0], pair[1], packetsToSend, true);
+        else TestSuite::failed++;
+
+        if (socketpair(AF_UNIX, SOCK_DGRAM, 0, pair) == 0) PosixLink(pair[0], pair[1], packetsToSend, false);
+        else TestSuite::failed++;
+
+        // a raw pty passes every byte through untouched, the slave hanging up reads EIO on the master
+        const int master = posix_openpt(O_RDWR | O_NOCTTY);
+        const int slave = master >= 0 && grantpt(master) == 0 && unlockpt(master) == 0 ? ::open(ptsname(master), O_RDWR | O_NOCTTY) : -1;
+        if (slave >= 0 && trns::posix::MakeRaw(slave, 0)) PosixLink(slave, master, packetsToSend, true);
+        else TestSuite::failed++;
+
+        double failedPercent = 100.0 * (double)TestSuite::failed / (double)(3*packetsToSend);
+        double recvPercent =   100.0 * (double)TestSuite::received / (double)(3*packetsToSend);
+
+        std::cout << "\t" << TestSuite::elapsed << " polls elapsed\n";
+        std::cout << "\tFailed: " << TestSuite::failed << "/" << 3*packetsToSend << " packets (" << failedPercent << "%)\n";
+        std::cout << "\tRecieved " << TestSuite::received << "/" << 3*packetsToSend << " packets (" << recvPercent << "%)\n\n";
+    }
+    static void T21TestGateway(size_t packetsToSend) {
+        TestSuite::elapsed = 0;
+        TestSuite::received = 0;
+        TestSuite::failed = 0;
+
+        static constexpr uint32_t LINKS = 32;
+
+        std::cout << "Running T21 (" << packetsToSend << " packets, " << LINKS << " links):\n";
+
+        // links are polled memory streams but for one socket pair that is waited on
+        std::vector<std::unique_ptr<TestTransportLayer>> streams;
+        int pair[2];
+        if (socketpair(AF_UNIX, SOCK_STREAM, 0, pair) != 0) TestSuite::failed++;
+        trns::FdTransport<> socketTx(pair[0]);
+        trns::FdTransport<> socketRx(pair[1]);
+        pckt::PacketManager<TestConfig, trns::FdTransport<>> socketManager(socketTx);
+
+        trns::Gateway<TestConfig> gateway(3);
+        sequences.assign(LINKS, 0);
+
+        for (size_t l = 0; l + 1 < LINKS; l++) {
+            streams.emplace_back(new TestTransportLayer());
+            if (gateway.Add(*streams.back()) != (int)l) TestSuite::failed++;
+        }
+
+        if (gateway.Add(socketRx, pair[1]) != (int)LINKS-1) TestSuite::failed++;
+
+        // the memory streams are filled before the workers start, they aren't thread safe
+        uint32_t sent[LINKS] = {};
+        std::mt19937 gen(21);
+        for (size_t i = 0; i < packetsToSend; i++) {
+            const uint32_t link = gen() % (LINKS-1);
+            uint8_t frame[TestConfig::MAX_PAYLOAD_SIZE];
+            memcpy(frame, &sent[link], 4);
+            memcpy(frame + 4, &link, 4);
+            sent[link]++;
+
+            Manager tx(*streams[link]);
+            tx.Send(pckt::Type::DataPacket, frame, sizeof(frame));
+        }
+
+        gateway.Start();
+
+        // the socket link is fed while the workers run, frames are drained throughout
+        sent[LINKS-1] = (uint32_t)(packetsToSend / LINKS);
+        for (uint32_t seq = 0; seq < sent[LINKS-1]; seq++) {
+            const uint32_t link = LINKS-1;
+            uint8_t frame[TestConfig::MAX_PAYLOAD_SIZE];
+            memcpy(frame, &seq, 4);
+            memcpy(frame + 4, &link, 4);
+
+            while (socketManager.Send(pckt::Type::DataPacket, frame, sizeof(frame)) == pckt::SendStatus::WouldBlock) {
+                gateway.Drain(0, 1, GatewayFrame);
+            }
+
+            if (seq % 256 == 0) gateway.Drain(0, 1, GatewayFrame);
+        }
+
+        const size_t expected = packetsToSend + sent[LINKS-1];
+        const auto start = std::chrono::steady_clock::now();
+        while (TestSuite::received + TestSuite::failed < expected && std::chrono::steady_clock::now() - start < std::chrono::seconds(10)) {
+            if (!gateway.Drain(0, 1, GatewayFrame)) std::this_thread::yield();
+        }
+
+        gateway.Stop();
+        gateway.Drain(0, 1, GatewayFrame);
+
+        for (size_t l = 0; l < LINKS; l++) {
+            if (sequences[l] != sent[l]) TestSuite::failed++;
+        }
+
+        double failedPercent = 100.0 * (double)TestSuite::failed / (double)expected;
+        double recvPercent =   100.0 * (double)TestSuite::received / (double)expected;
+
+        std::cout << "\tFailed: " << TestSuite::failed << "/" << expected << " packets (" << failedPercent << "%)\n";
+        std::cout << "\tRecieved " << TestSuite::received << "/" << expected << " packets (" << recvPercent << "%)\n\n";
+    }
+    static void T22TestCapture(size_t packetsToSend) {
+        TestSuite::elapsed = 0;
+        TestSuite::received = 0;
+        TestSuite::failed = 0;
+
+        std::cout << "Running T22 (" << packetsToSend << " packets):\n";
+
+        const std::string path = "/tmp/pckt_t22_" + std::to_string(getpid()) + ".log";
+        size_t bytesRead = 0;
+
+        // both ends of a loopback recorded, frames split across spans with noise between them
+        {
+            TestTransportLayer transport;
+            transport.spans = true;
+            transport.maxSpan = 20;
+            trns::CaptureLog<> log(path.c_str());
+            trns::CaptureTransport<TestTransportLayer> capture(transport, log);
+            Manager txManager(capture);
+            Manager rxManager(capture);
+            rxManager.Callback(pckt::Type::DataPacket, Handler);
+
+            std::mt19937 gen(22);
+            for (size_t i = 0; i < packetsToSend; i++) {
+                txManager.Send(pckt::Type::DataPacket, TestSuite::payload, TestConfig::MAX_PAYLOAD_SIZE);
+                if (gen() % 8 == 0) {
+                    const uint8_t noise[3] = { (uint8_t)gen(), (uint8_t)gen(), (uint8_t)gen() };
+                    transport.write(noise, sizeof(noise));
+                }
+
+                bytesRead += transport.buffer.size() - transport.head;
+                rxManager.Update();
+            }
+
+            if (!log.Flush()) TestSuite::failed++;
+        }
+
+        // replaying what was read reproduces every frame, written chunks are skipped
+        const size_t live = TestSuite::received;
+        TestSuite::received = 0;
+        {
+            trns::ReplayTransport replay(path.c_str());
+            pckt::PacketManager<TestConfig, trns::ReplayTransport> manager(replay);
+            manager.Callback(pckt::Type::DataPacket, Handler);
+
+            if (!replay.IsOpen()) TestSuite::failed++;
+            while (!replay.Done()) {
+                manager.Update();
+                TestSuite::elapsed++;
+            }
+
+            if (replay.Replayed() != bytesRead) TestSuite::failed++;
+        }
+
+        if (TestSuite::received != live || live != packetsToSend) TestSuite::failed++;
+
+        // in real time the second chunk waits as long as it did when recorded
+        {
+            trns::CaptureLog<> log(path.c_str());
+            log.Record(false, TestSuite::payload, 4);
+            log.Record(true, TestSuite::payload, 2);
+            std::this_thread::sleep_for(std::chrono::milliseconds(30));
+            log.Record(false, TestSuite::payload + 4, 4);
+        }
+
+        {
+            trns::ReplayTransport replay(path.c_str(), true);
+            uint8_t chunk[8];
+            if (replay.read(chunk, sizeof(chunk)) != 4 || memcmp(chunk, TestSuite::payload, 4)) TestSuite::failed++;
+            if (replay.available()) TestSuite::failed++;
+
+            std::this_thread::sleep_for(std::chrono::milliseconds(35));
+            if (replay.read(chunk, sizeof(chunk)) != 4 || memcmp(chunk, TestSuite::payload + 4, 4) || !replay.Done()) TestSuite::failed++;
+        }
+
+        unlink(path.c_str());
+
+        double failedPercent = 100.0 * (double)TestSuite::failed / (double)packetsToSend;
+        double recvPercent =   100.0 * (double)TestSuite::received / (double)packetsToSend;
+
+        std::cout << "\t" << TestSuite::elapsed << " updates elapsed replaying " << bytesRead << " bytes\n";
+        std::cout << "\tFailed: " << TestSuite::failed << "/" << packetsToSend << " packets (" << failedPercent << "%)\n";
+        std::cout << "\tRecieved " << TestSuite::received << "/" << packetsToSend << " packets (" << recvPercent << "%)\n\n";
+    }
+    static void T23TestZeroCopy(size_t packetsToSend) {
+        TestSuite::elapsed = 0;
+        TestSuite::received = 0;
+        TestSuite::failed = 0;
+        TestSuite::inPlace = 0;
+        TestTransportLayer transport;
+        pckt::PacketManager<VariableConfig> txManager(transport);
+        pckt::PacketManager<VariableConfig> rxManager(transport);
+
+        std::cout << "Running T23 (" << packetsToSend << " packets):\n";
+
+        // frames are whole in the spans, every one reaches the handler where it lies
+        transport.spans = true;
+        viewed = &transport;
+        rxManager.Callback(pckt::Type::DataPacket, ViewHandler);
+
+        for (size_t i = 0; i < packetsToSend; i++) {
+            const size_t len = i % (VariableConfig::MAX_PAYLOAD_SIZE + 1);
+
+            uint8_t* payload = txManager.BeginSend(pckt::Type::DataPacket);
+            if (!payload) {
+                TestSuite::failed++;
+                continue;
+            }
+
+            for (size_t b = 0; b < len; b++) payload[b] = (uint8_t)(len + b);
+            if (txManager.Commit(len) != pckt::SendStatus::Sent) TestSuite::failed++;
+
+            rxManager.Update();
+            TestSuite::elapsed++;
+        }
+
+        if (TestSuite::inPlace != packetsToSend) TestSuite::failed++;
+
+        // nothing to commit without a frame, and no frame while the last one is still waiting on the transport
+        if (txManager.Commit(4) != pckt::SendStatus::WouldBlock) TestSuite::failed++;
+
+        TestTransportLayer target;
+        ThrottledTransportLayer throttled(target);
+        throttled.maxWrite = 0;
+        Manager blocked(throttled);
+        uint8_t* first = blocked.BeginSend(pckt::Type::DataPacket);
+        if (!first || blocked.Commit(2) != pckt::SendStatus::Queued || blocked.BeginSend(pckt::Type::DataPacket)) TestSuite::failed++;
+
+        // fixed length frames have the unwritten tail zeroed, not whatever the buffer held
+        throttled.maxWrite = SIZE_MAX;
+        blocked.Flush();
+        memcpy(blocked.BeginSend(pckt::Type::DataPacket), TestSuite::payload, 3);
+        blocked.Commit(3);
+        const Packet& sent = *reinterpret_cast<const Packet*>(target.buffer.data() + target.buffer.size() - sizeof(Packet));
+        if (memcmp(sent.payload, TestSuite::payload, 3) || sent.payload[3] || sent.payload[7]) TestSuite::failed++;
+
+        double failedPercent = 100.0 * (double)TestSuite::failed / (double)packetsToSend;
+        double recvPercent =   100.0 * (double)TestSuite::received / (double)packetsToSend;
+
+        std::cout << "\t" << TestSuite::inPlace << " packets handled in place\n";
+        std::cout << "\tFailed: " << TestSuite::failed << "/" << packetsToSend << " packets (" << failedPercent << "%)\n";
+        std::cout << "\tRecieved " << TestSuite::received << "/" << packetsToSend << " packets (" << recvPercent << "%)\n\n";
+    }
+
+    static void T24TestSparseDispatch(size_t packetsToSend) {
+        using SparseManager = pckt::PacketManager<SparseConfig>;
+        TestSuite::elapsed = 0;
+        TestSuite::received = 0;
+        TestSuite::failed = 0;
+        TestTransportLayer transport;
+        SparseManager txManager(transport);
+        SparseManager rxManager(transport);
+
+        std::cout << "Running T24 (" << packetsToSend << " packets):\n";
+
+        // 150 ids spread over the 16 bit range, half bound as member functions and half with a context
+        std::mt19937 rng(24);
+        std::vector<Route> routes;
+        while (routes.size() < 150) {
+            const uint16_t id = (uint16_t)rng();
+            bool taken = id < SparseConfig::PACKET_COUNT;
+            for (const Route& r : routes) taken |= r.id == id;
+            if (!taken) routes.push_back(Route{ id, 0, 0 });
+        }
+
+        for (size_t r = 0; r < routes.size(); r++) {
+            const SparseManager::Delegate handler = r % 2 ? SparseManager::Delegate::Method<Route, &Route::OnPacket>(routes[r])
+                                                          : SparseManager::Delegate::Bind<Route, &TestSuite::RouteHandler>(routes[r]);
+            if (!rxManager.Callback((pckt::Type)routes[r].id, handler)) TestSuite::failed++;
+        }
+
+        // dense types take delegates too
+        Route data = { (uint16_t)pckt::Type::DataPacket, 0, 0 };
+        rxManager.Callback(pckt::Type::DataPacket, SparseManager::Delegate::Method<Route, &Route::OnPacket>(data));
+
+        // every 8th frame has an id nobody registered
+        size_t unknown = 0;
+        for (size_t i = 0; i < packetsToSend; i++) {
+            Route* route = i % 8 == 7 ? nullptr : i % 8 == 6 ? &data : &routes[(i * 7) % routes.size()];
+            const uint16_t id = route ? route->id : (uint16_t)(routes[i % routes.size()].id ^ 0x5A5A);
+
+            bool registered = id < SparseConfig::PACKET_COUNT;
+            for (const Route& r : routes) registered |= r.id == id;
+
+            uint8_t payload[SparseConfig::MAX_PAYLOAD_SIZE] = {};
+            memcpy(payload, &id, sizeof(id));
+            txManager.Send((pckt::Type)id, payload, sizeof(payload));
+            rxManager.Update();
+
+            if (registered) {
+                if (route) route->expected++;
+            } else {
+                unknown++;
+            }
+
+            TestSuite::elapsed++;
+        }
+
+        for (const Route& r : routes) {
+            if (r.hits != r.expected) TestSuite::failed++;
+            TestSuite::received += r.hits;
+        }
+
+        if (data.hits != data.expected) TestSuite::failed++;
+        TestSuite::received += data.hits;
+        if (rxManager.Stats().badTypes != unknown) TestSuite::failed++;
+
+        // an empty handler frees the id, it is then dropped as a bad type, the others keep their slots
+        const size_t badTypes = rxManager.Stats().badTypes;
+        uint8_t payload[SparseConfig::MAX_PAYLOAD_SIZE] = {};
+        memcpy(payload, &routes[0].id, sizeof(routes[0].id));
+        if (!rxManager.Callback((pckt::Type)routes[0].id, nullptr)) TestSuite::failed++;
+
+        txManager.Send((pckt::Type)routes[0].id, payload, sizeof(payload));
+        memcpy(payload, &routes[1].id, sizeof(routes[1].id));
+        txManager.Send((pckt::Type)routes[1].id, payload, sizeof(payload));
+        rxManager.Update();
+        if (rxManager.Stats().badTypes != badTypes + 1 || routes[1].hits != routes[1].expected + 1) TestSuite::failed++;
+
+        // out of TypeId's range, then a full table
+        if (rxManager.Callback((pckt::Type)0x10000, SparseManager::Delegate::Method<Route, &Route::OnPacket>(data))) TestSuite::failed++;
+
+        size_t added = 0;
+        for (uint16_t id = 0x8000; added < SparseConfig::SPARSE_HANDLERS; id++) {
+            if (rxManager.Callback((pckt::Type)id, SparseManager::Delegate::Method<Route, &Route::OnPacket>(data))) added++;
+            else break;
+        }
+
+        if (added != SparseConfig::SPARSE_HANDLERS - routes.size() + 1) TestSuite::failed++;
+
+        // ids crowded into 2 of the 16 buckets until one can't be placed, the ones before it keep their handlers
+        const uint16_t crowded[] = { 38684, 16330, 35758, 29589, 44067, 14643, 17818, 59848, 38508, 731, 26730, 2137, 26641, 59766,
+                                     31022, 59069, 50909, 64188, 3232, 57466, 32405, 18747, 47813, 48983, 50250, 17440, 55754, 42147 };
+        pckt::SparseHandlers<CrowdedConfig> table;
+        for (uint16_t id : crowded) {
+            if (!table.Set(id, Handler<pckt::Packet<CrowdedConfig>>)) TestSuite::failed++;
+        }
+
+        if (table.Set(55430, Handler<pckt::Packet<CrowdedConfig>>)) TestSuite::failed++;
+        for (uint16_t id : crowded) {
+            if (!table.Find(id)) TestSuite::failed++;
+        }
+
+        double failedPercent = 100.0 * (double)TestSuite::failed / (double)packetsToSend;
+        double recvPercent =   100.0 * (double)TestSuite::received / (double)(packetsToSend - unknown);
+
+        std::cout << "\t" << unknown << " packets of unregistered types dropped\n";
+        std::cout << "\tFailed: " << TestSuite::failed << "/" << packetsToSend << " packets (" << failedPercent << "%)\n";
+        std::cout << "\tRecieved " << TestSuite::received << "/" << packetsToSend - unknown << " packets (" << recvPercent << "%)\n\n";
+    }
+
+    static void T25TestPacing(size_t packetsToSend) {
+        TestSuite::elapsed = 0;
+        TestSuite::received = 0;
+        TestSuite::failed = 0;
+        TestTransportLayer transport;
+        ThrottledTransportLayer sender(transport);
+        pckt::PacketManager<PacedConfig> txManager(sender);
+        pckt::PacketManager<PacedConfig> rxManager(transport);
+        rxManager.Callback(pckt::Type::DataPacket, LatestHandler<pckt::Packet<PacedConfig>>);
+        latest.clear();
+        latestAt.clear();
+
+        std::cout << "Running T25 (" << packetsToSend << " packets):\n";
+
+        // a value every 100 us, 130 times what the link carries
+        std::vector<unsigned long> sentAt;
+        uint8_t payload[PacedConfig::MAX_PAYLOAD_SIZE] = {};
+        const unsigned long start = pckt::Micros();
+
+        for (uint32_t i = 0; i < packetsToSend; i++) {
+            memcpy(payload, &i, sizeof(i));
+            sentAt.push_back(pckt::Micros());
+            if (txManager.Send(pckt::Type::DataPacket, payload, sizeof(payload)) == pckt::SendStatus::WouldBlock) TestSuite::failed++;
+
+            const unsigned long due = sentAt.back() + 100;
+            do {
+                txManager.Update();
+                rxManager.Update();
+            } while ((long)(pckt::Micros() - due) < 0);
+
+            TestSuite::elapsed++;
+        }
+
+        // held to the rate, a frame of burst on top, but kept busy
+        const double seconds = (double)(pckt::Micros() - start) / 1e6;
+        const double rate = (double)txManager.Stats().bytesOut / seconds;
+        if (rate > PacedConfig::TX_RATE + (sizeof(pckt::Packet<PacedConfig>) + 1) / seconds || rate < PacedConfig::TX_RATE / 2) TestSuite::failed++;
+
+        // only ever newer values, each on the wire within two frame times of being sent rather than behind a backlog
+        const unsigned long frameTime = 1000000ul * sizeof(pckt::Packet<PacedConfig>) / PacedConfig::TX_RATE;
+        for (size_t k = 0; k < latest.size(); k++) {
+            if (latest[k] >= sentAt.size() || (k && latest[k] <= latest[k-1])) TestSuite::failed++;
+            else if (latestAt[k] - sentAt[latest[k]] > 2*frameTime) TestSuite::failed++;
+            else TestSuite::received++;
+        }
+
+        // a blocked link keeps the newest value of each channel, whatever was queued before it stays in order
+        TestTransportLayer target;
+        ThrottledTransportLayer throttled(target);
+        throttled.maxWrite = 0;
+        pckt::PacketManager<CoalesceConfig> blocked(throttled);
+        pckt::PacketManager<CoalesceConfig> receiver(target);
+        receiver.Callback(pckt::Type::DataPacket, LatestHandler<pckt::Packet<CoalesceConfig>>);
+        latest.clear();
+
+        for (uint32_t i = 0; i < 100; i++) {
+            const uint32_t v = i % 2 ? 1000 + i : i;
+            memcpy(payload, &v, sizeof(v));
+            blocked.SetChannel((uint8_t)(i % 2));
+            if (blocked.Send(pckt::Type::DataPacket, payload, sizeof(payload)) != pckt::SendStatus::Queued) TestSuite::failed++;
+        }
+
+        if (blocked.Held() != 2) TestSuite::failed++;
+
+        // critical packets are never replaced, they wait for room like any other
+        blocked.SetCritical(true);
+        if (blocked.Send(pckt::Type::DataPacket, payload, sizeof(payload)) != pckt::SendStatus::WouldBlock) TestSuite::failed++;
+
+        throttled.maxWrite = SIZE_MAX;
+        for (int u = 0; u < 4; u++) {
+            blocked.Flush();
+            blocked.Update();
+            receiver.Update();
+        }
+
+        uint32_t last[2] = { 0, 0 };
+        bool seen[2] = { false, false };
+        for (uint32_t v : latest) {
+            const size_t channel = v >= 1000;
+            if (seen[channel] && v <= last[channel]) TestSuite::failed++;
+            last[channel] = v;
+            seen[channel] = true;
+        }
+
+        if (blocked.Held() || latest.size() >= 20 || last[0] != 98 || last[1] != 1099) TestSuite::failed++;
+
+        double failedPercent = 100.0 * (double)TestSuite::failed / (double)packetsToSend;
+
+        std::cout << "\t" << TestSuite::received << " of " << packetsToSend << " values reached the wire at " << rate << " B/s\n";
+        std::cout << "\tFailed: " << TestSuite::failed << "/" << packetsToSend << " packets (" << failedPercent << "%)\n\n";
+    }
+
+    static void T26TestConcurrent(size_t packetsToSend) {
+        TestSuite::elapsed = 0;
+        TestSuite::received = 0;
+        TestSuite::failed = 0;
+
+        static constexpr uint32_t PRODUCERS = 8;
+
+        std::cout << "Running T26 (" << packetsToSend << " packets, " << PRODUCERS << " threads):\n";
+
+        // the sender waits on its fd with an interval long enough that only a wakeup gets a late send out in time,
+        // the receiver is polled and hands frames to 2 workers
+        int pair[2];
+        if (socketpair(AF_UNIX, SOCK_STREAM, 0, pair) != 0) TestSuite::failed++;
+        trns::FdTransport<> txTransport(pair[0]);
+        trns::FdTransport<> rxTransport(pair[1]);
+        trns::ConcurrentManager<ConcurrentConfig, trns::FdTransport<>> tx(txTransport, pair[0], 0, 1000);
+        trns::ConcurrentManager<ConcurrentConfig, trns::FdTransport<>> rx(rxTransport, -1, 2);
+
+        if (!rx.Callback(pckt::Type::DataPacket, ConcurrentHandler) || !rx.Callback(pckt::Type::None, ConcurrentHandler)) TestSuite::failed++;
+        sequences.assign(PRODUCERS, 0);
+        handled = 0;
+        mishandled = 0;
+
+        rx.Start();
+        tx.Start();
+
+        // every thread sends its own sequence, one frame in 64 critical
+        const uint32_t perProducer = (uint32_t)(packetsToSend / PRODUCERS);
+        std::vector<std::thread> producers;
+        for (uint32_t p = 0; p < PRODUCERS; p++) {
+            producers.emplace_back([&tx, p, perProducer] {
+                const pckt::Type type = p % 2 ? pckt::Type::None : pckt::Type::DataPacket;
+                uint8_t frame[ConcurrentConfig::MAX_PAYLOAD_SIZE];
+                memcpy(frame + 4, &p, 4);
+
+                for (uint32_t seq = 0; seq < perProducer; seq++) {
+                    memcpy(frame, &seq, 4);
+                    const uint8_t flags = seq % 64 == 0 ? 0b10000000 : 0;
+                    while (tx.Send(type, frame, sizeof(frame), flags) == pckt::SendStatus::WouldBlock) std::this_thread::yield();
+                }
+            });
+        }
+
+        for (auto& t : producers) t.join();
+
+        const size_t expected = (size_t)perProducer * PRODUCERS;
+        auto start = std::chrono::steady_clock::now();
+        while (handled + mishandled < expected && std::chrono::steady_clock::now() - start < std::chrono::seconds(20)) {
+            std::this_thread::sleep_for(std::chrono::milliseconds(1));
+        }
+
+        // both link threads have gone to sleep, a send must wake the sender's rather than wait out its interval
+        std::this_thread::sleep_for(std::chrono::milliseconds(50));
+        const uint32_t last = 0;
+        uint8_t frame[ConcurrentConfig::MAX_PAYLOAD_SIZE] = {};
+        memcpy(frame, &perProducer, 4);
+        memcpy(frame + 4, &last, 4);
+
+        start = std::chrono::steady_clock::now();
+        if (tx.Send(pckt::Type::DataPacket, frame, sizeof(frame)) != pckt::SendStatus::Queued) TestSuite::failed++;
+        while (handled + mishandled < expected + 1 && std::chrono::steady_clock::now() - start < std::chrono::seconds(2)) {
+            std::this_thread::sleep_for(std::chrono::microseconds(100));
+        }
+
+        if (std::chrono::steady_clock::now() - start > std::chrono::milliseconds(500)) TestSuite::failed++;
+
+        tx.Stop();
+        rx.Stop();
+
+        for (uint32_t p = 0; p < PRODUCERS; p++) {
+            if (sequences[p] != perProducer + (p == last)) TestSuite::failed++;
+        }
+
+        const pckt::LinkStats rxStats = rx.LinkManager().Stats();
+        if (rxStats.checksumFailures || rxStats.resyncs) TestSuite::failed++;
+
+        TestSuite::received = handled;
+        TestSuite::failed += mishandled;
+
+        double failedPercent = 100.0 * (double)TestSuite::failed / (double)(expected + 1);
+        double recvPercent =   100.0 * (double)TestSuite::received / (double)(expected + 1);
+
+        std::cout << "\tFailed: " << TestSuite::failed << "/" << expected + 1 << " packets (" << failedPercent << "%)\n";
+        std::cout << "\tRecieved " << TestSuite::received << "/" << expected + 1 << " packets (" << recvPercent << "%)\n\n";
+    }
+
+    static void T27TestLinkEmulator(size_t packetsToSend) {
+        TestSuite::elapsed = 0;
+        TestSuite::received = 0;
+        TestSuite::failed = 0;
+
+        std::cout << "Running T27 (" << packetsToSend << " packets):\n";
+
+        // a seed damages the same bytes every run, another seed other bytes
+        trns::LinkModel noisy;
+        noisy.bitErrorRate = 2e-4;
+        noisy.dropRate = 1e-4;
+        noisy.duplicateRate = 1e-4;
+        noisy.shortReadRate = 0.5;
+
+        const LinkRun first = RunLink(noisy, packetsToSend);
+        const LinkRun again = RunLink(noisy, packetsToSend);
+        noisy.seed = 2;
+        const LinkRun reseeded = RunLink(noisy, packetsToSend);
+
+        if (first.delivered != again.delivered || memcmp(&first.damage, &again.damage, sizeof(trns::LinkDamage)) != 0) TestSuite::failed++;
+        if (first.damage.bitsFlipped == reseeded.damage.bitsFlipped && first.delivered == reseeded.delivered) TestSuite::failed++;
+        if (!first.damage.bytesDropped || !first.damage.bytesDuplicated || !first.damage.shortReads) TestSuite::failed++;
+
+        // the damage done follows the rates, every byte sent is about 2.5 bytes of frame on average
+        const double bits = 8.0 * (double)packetsToSend * (VariableConfig::MAX_PAYLOAD_SIZE / 2.0 + sizeof(pckt::Packet<VariableConfig>) - VariableConfig::MAX_PAYLOAD_SIZE);
+        const double flipped = first.damage.bitsFlipped / (bits * noisy.bitErrorRate);
+        if (flipped < 0.9 || flipped > 1.1) TestSuite::failed++;
+
+        // errors in bursts at the same mean rate hit fewer frames, a frame takes several errors as easily as one
+        trns::LinkModel bursty;
+        bursty.enterBurst = 0.001;
+        bursty.leaveBurst = 0.05;
+        bursty.burstErrorRate = noisy.bitErrorRate * (bursty.enterBurst + bursty.leaveBurst) / bursty.enterBurst;
+        const LinkRun burst = RunLink(bursty, packetsToSend);
+
+        const double burstFlipped = burst.damage.bitsFlipped / (bits * noisy.bitErrorRate);
+        if (burstFlipped < 0.7 || burstFlipped > 1.3) TestSuite::failed++;
+        if (burst.delivered <= first.delivered) TestSuite::failed++;
+
+        // nothing corrupted reaches a handler, what is delivered is most frames
+        TestSuite::failed += first.failed + again.failed + reseeded.failed + burst.failed;
+        if (first.delivered < packetsToSend * 8 / 10) TestSuite::failed++;
+
+        // a 1 Mbaud link 2 to 3 ms long, frames can't arrive faster than the rate or sooner than the latency
+        trns::LinkModel timed = trns::LinkModel::Uart(1000000);
+        timed.latency = 2000;
+        timed.jitter = 1000;
+        timed.shortReadRate = 0.3;
+        timed.shortWriteRate = 0.3;
+
+        TestTransportLayer loopback;
+        trns::LinkEmulator<TestTransportLayer> link(loopback, timed);
+        pckt::PacketManager<QueueConfig> txManager(link);
+        pckt::PacketManager<QueueConfig> rxManager(link);
+        rxManager.Callback(pckt::Type::DataPacket, LatestHandler<pckt::Packet<QueueConfig>>);
+        latest.clear();
+        latestAt.clear();
+
+        const uint32_t frames = 2000;
+        std::vector<unsigned long> sentAt;
+        uint8_t payload[QueueConfig::MAX_PAYLOAD_SIZE] = {};
+        const unsigned long start = pckt::Micros();
+
+        for (uint32_t i = 0; i < frames; ) {
+            memcpy(payload, &i, sizeof(i));
+            if (txManager.Send(pckt::Type::DataPacket, payload, sizeof(payload)) != pckt::SendStatus::WouldBlock) {
+                sentAt.push_back(pckt::Micros());
+                i++;
+            }
+
+            txManager.Flush();
+            rxManager.Update();
+        }
+
+        while (latest.size() < frames && pckt::Micros() - start < 5000000) {
+            txManager.Flush();
+            rxManager.Update();
+        }
+
+        const double seconds = (latestAt.empty() ? 0 : latestAt.back() - start) / 1e6;
+        const double rate = frames * sizeof(pckt::Packet<QueueConfig>) / seconds;
+        if (rate > timed.bytesPerSecond * 1.05) TestSuite::failed++;
+
+        for (uint32_t i = 0; i < latest.size(); i++) {
+            if (latest[i] != i || latestAt[i] - sentAt[i] < timed.latency) TestSuite::failed++;
+        }
+
+        if (latest.size() != frames) TestSuite::failed++;
+        if (!link.Damage().shortReads || !link.Damage().shortWrites) TestSuite::failed++;
+
+        TestSuite::received = first.delivered;
+
+        double failedPercent = 100.0 * (double)TestSuite::failed / (double)packetsToSend;
+        double recvPercent =   100.0 * (double)TestSuite::received / (double)packetsToSend;
+
+        std::cout << "\tFailed: " << TestSuite::failed << "/" << packetsToSend << " packets (" << failedPercent << "%)\n";
+        std::cout << "\tRecieved " << TestSuite::received << "/" << packetsToSend << " packets (" << recvPercent << "%)\n";
+        std::cout << "\t" << first.damage.bitsFlipped << " bits flipped, " << burst.delivered << " delivered with the same rate in bursts, "
+                  << rate / 1000 << " kB/s of " << timed.bytesPerSecond / 1000 << "\n\n";
+    }
 };
 
 size_t TestSuite::received = 0;
 size_t TestSuite::elapsed = 0;
 size_t TestSuite::failed = 0;
-uint8_t TestSuite::payload[MAX_PAYLOAD_SIZE] = { 0xCC, 0xCC, 0xCC, 0xFF, 0xFF, 0xFF, 0xAA, 0xAA };
+std::vector<uint8_t> TestSuite::delivered;
+std::vector<uint8_t> TestSuite::channels;
+size_t TestSuite::messages = 0;
+std::vector<uint32_t> TestSuite::sequences;
+TestTransportLayer* TestSuite::viewed = nullptr;
+size_t TestSuite::inPlace = 0;
+std::atomic<size_t> TestSuite::handled(0);
+std::atomic<size_t> TestSuite::mishandled(0);
+std::vector<uint32_t> TestSuite::latest;
+std::vector<unsigned long> TestSuite::latestAt;
+std::queue<Pose> TestSuite::poses;
+std::queue<Reading> TestSuite::readings;
+std::queue<Status> TestSuite::statuses;
+uint8_t TestSuite::payload[TestConfig::MAX_PAYLOAD_SIZE] = { 0xCC, 0xCC, 0xCC, 0xFF, 0xFF, 0xFF, 0xAA, 0xAA };
 
 int main() {
     TestSuite::T1TestManager(5000000);
-    TestSuite::T2TestManager(5000000, 2*sizeof(pckt::Packet));
+    TestSuite::T2TestManager(5000000, 2*sizeof(Packet));
     TestSuite::T3TestManager(5000000);
     TestSuite::T4TestManager(5000000);
     TestSuite::T5TestManager(5000000);
+    TestSuite::T6TestChecksum(100000);
+    TestSuite::T7TestRingBuffer(5000000);
+    TestSuite::T8TestBatchDecode(5000000);
+    TestSuite::T9TestPartialWrites(5000000);
+    TestSuite::T10TestVariableLength(5000000);
+    TestSuite::T11TestTxQueue(5000000);
+    TestSuite::T12TestReliable(20000);
+    TestSuite::T13TestStats(1000000);
+    TestSuite::T14TestCobs(5000000);
+    TestSuite::T15TestResync(1000000);
+    TestSuite::T16TestChannels(1000000);
+    TestSuite::T17TestMessages(20000);
+    TestSuite::T18TestDelta(1000000);
+    TestSuite::T19TestSchema(1000000);
+    TestSuite::T20TestPosix(200000);
+    TestSuite::T21TestGateway(200000);
+    TestSuite::T22TestCapture(1000000);
+    TestSuite::T23TestZeroCopy(5000000);
+    TestSuite::T24TestSparseDispatch(1000000);
+    TestSuite::T25TestPacing(5000);
+    TestSuite::T26TestConcurrent(400000);
+    TestSuite::T27TestLinkEmulator(200000);
 }